@@ -0,0 +1,67 @@
+///compares the 30 bit and the 62 bit limb layouts of uInt, the layout is
+///picked at compile time so the driver is built once for each:
+///
+///  g++ -std=c++17 -O2 -fpermissive -Iinclude include/Bignum.cpp bench/bignum_limb_layout.cpp -o bench30
+///  g++ -std=c++17 -O2 -fpermissive -Iinclude -DACHIBULUP__BIGNUM_WIDE_LIMB=1 include/Bignum.cpp bench/bignum_limb_layout.cpp -o bench62
+///
+///the operand sizes are in bits, so the lines of the two runs line up;
+///extra arguments replace the default sizes
+
+#include "Bignum.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace Achibulup;
+
+///the best per call time in microseconds over a few runs of reps calls
+template<typename Fun>
+double bestTime(int reps, Fun fun)
+{
+    double best = 1e300;
+    for (int run = 0; run < 5; ++run) {
+      auto start = std::chrono::steady_clock::now();
+      for (int i = 0; i < reps; ++i) fun();
+      std::chrono::duration<double, std::micro> elapsed =
+          std::chrono::steady_clock::now() - start;
+      best = std::min(best, elapsed.count() / reps);
+    }
+    return best;
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<long> sizes = {960, 3000, 15000, 90000, 1000000};
+    if (argc > 1) {
+      sizes.clear();
+      for (int i = 1; i < argc; ++i) sizes.push_back(std::atol(argv[i]));
+    }
+
+    std::printf("%d bit limbs\n", n_Int::k_BaseBinDigit);
+    std::printf("%10s %12s %12s %12s %12s %12s\n", "bits",
+                "mul us", "square us", "div us", "toString us", "parse us");
+    std::mt19937_64 engine(1);
+    for (long bits : sizes) {
+      const uInt a = randomBits(bits, engine) | (uInt(1) << int(bits - 1));
+      const uInt b = randomBits(bits, engine) | (uInt(1) << int(bits - 1));
+      const uInt wide = a * b + b;
+      const std::string digits = a.toString();
+      ///fewer calls as the operands grow, at least one
+      const int reps = std::max<long>(1, 2000000000L / (bits * bits));
+
+      volatile bool sink = false;
+      const double mul = bestTime(reps, [&]{ sink = bool(a * b); });
+      const double square = bestTime(reps, [&]{ sink = bool(a.square()); });
+      const double div = bestTime(reps, [&]{ sink = bool(wide / a); });
+      const double out = bestTime(std::max(1, reps / 4),
+                                  [&]{ sink = a.toString().empty(); });
+      const double in = bestTime(std::max(1, reps / 4),
+                                 [&]{ sink = bool(uInt().parse(digits)); });
+      std::printf("%10ld %12.2f %12.2f %12.2f %12.2f %12.2f\n",
+                  bits, mul, square, div, out, in);
+    }
+    return 0;
+}
@@ -1,4 +1,22 @@
 #include "Bignum.hpp"
+#include <mutex>
+#include <atomic>
+#include <deque>
+#include <thread>
+#include <vector>
+#include <cctype>
+#include <climits>
+#include <exception>
+#include <functional>
+#include <condition_variable>
+
+#if ACHIBULUP__BIGNUM_SIMD && (defined(__GNUC__) || defined(__clang__)) \
+    && (defined(__x86_64__) || defined(__i386__))
+#define ACHIBULUP__BIGNUM_AVX2 1
+#include <immintrin.h>
+#else
+#define ACHIBULUP__BIGNUM_AVX2 0
+#endif
 
 namespace Achibulup
 {
@@ -83,7 +101,7 @@ static size_type maxXorSize(size_type left_size, size_type right_size)
 }
 static size_type maxShrSize(size_type left_size, size_t rhs)
 {
-    return std::max<base_type>(left_size - rhs / k_BaseBinDigit, 0);
+    return std::max<size_type>(left_size - rhs / k_BaseBinDigit, 0);
 }
 static size_type maxShlSize(size_type left_size, size_t rhs)
 {
@@ -102,6 +120,157 @@ size_type trimZero(const_pointer digits, size_type size)
     return size;
 }
 
+///the AVX2 kernels below are compiled for AVX2 whatever the build flags and 
+///only called after the CPU has been checked at runtime,
+///each handles whole blocks of limbs and returns how many it handled, 
+///the scalar loops of the callers finish the rest
+#if ACHIBULUP__BIGNUM_AVX2
+static bool detectAvx2()
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+static const bool k_HasAvx2 = detectAvx2();
+#else
+static constexpr bool k_HasAvx2 = false;
+#endif
+static constexpr size_type k_SimdThreshold = 16;
+
+static bool useSimd(size_type len)
+{
+    return len >= k_SimdThreshold && k_HasAvx2;
+}
+
+#if ACHIBULUP__BIGNUM_AVX2
+template<char op>
+__attribute__((target("avx2")))
+static size_type avx2Bitwise(const_pointer lhs, const_pointer rhs, 
+                             pointer res, size_type len)
+{
+    constexpr size_type k_Step = sizeof(__m256i) / sizeof(base_type);
+    size_type i = 0;
+    for (; i + k_Step <= len; i += k_Step) {
+      __m256i l = _mm256_loadu_si256((const __m256i*)(lhs + i));
+      __m256i r = _mm256_loadu_si256((const __m256i*)(rhs + i));
+      __m256i v = op == '&' ? _mm256_and_si256(l, r)
+                : op == '|' ? _mm256_or_si256(l, r)
+                :             _mm256_xor_si256(l, r);
+      _mm256_storeu_si256((__m256i*)(res + i), v);
+    }
+    return i;
+}
+#else
+template<char op>
+static size_type avx2Bitwise(const_pointer, const_pointer, pointer, size_type)
+{ return 0; }
+#endif
+
+///with 30 bit limbs a lane sum carries at most 1 into the next lane,
+///so the carries of a block of 8 lanes are resolved as a single 
+///addition of bit masks: generate marks the lanes that carry out, 
+///propagate the lanes that carry out only if a carry comes in
+#if ACHIBULUP__BIGNUM_AVX2 && !ACHIBULUP__BIGNUM_WIDE_LIMB
+__attribute__((target("avx2")))
+static __m256i avx2CarryLanes(unsigned generate, unsigned propagate, 
+                              calc_type &carry)
+{
+    const unsigned carries = 
+        ((generate | propagate) + generate + carry) ^ propagate;
+    carry = carries >> 8;
+    const __m256i bits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+    const __m256i mask = _mm256_and_si256(_mm256_set1_epi32(carries), bits);
+    return _mm256_cmpeq_epi32(mask, bits);
+}
+///normalizes the lane sums, which must be less than 2 * k_Base - 1
+__attribute__((target("avx2")))
+static __m256i avx2Normalize(__m256i sum, calc_type &carry)
+{
+    const __m256i limb_mask = _mm256_set1_epi32(k_Base - 1);
+    const unsigned generate = _mm256_movemask_ps(_mm256_castsi256_ps(
+        _mm256_slli_epi32(sum, 31 - k_BaseBinDigit)));
+    const unsigned propagate = _mm256_movemask_ps(_mm256_castsi256_ps(
+        _mm256_cmpeq_epi32(sum, limb_mask)));
+    const __m256i carries = avx2CarryLanes(generate, propagate, carry);
+    return _mm256_and_si256(_mm256_sub_epi32(sum, carries), limb_mask);
+}
+__attribute__((target("avx2")))
+static size_type avx2Add(const_pointer lhs, const_pointer rhs, 
+                         pointer res, size_type len, calc_type &carry)
+{
+    size_type i = 0;
+    for (; i + 8 <= len; i += 8) {
+      __m256i l = _mm256_loadu_si256((const __m256i*)(lhs + i));
+      __m256i r = _mm256_loadu_si256((const __m256i*)(rhs + i));
+      _mm256_storeu_si256((__m256i*)(res + i), 
+                          avx2Normalize(_mm256_add_epi32(l, r), carry));
+    }
+    return i;
+}
+__attribute__((target("avx2")))
+static size_type avx2Sub(const_pointer lhs, const_pointer rhs, 
+                         pointer res, size_type len, calc_type &borrow)
+{
+    const __m256i limb_mask = _mm256_set1_epi32(k_Base - 1);
+    size_type i = 0;
+    for (; i + 8 <= len; i += 8) {
+      __m256i l = _mm256_loadu_si256((const __m256i*)(lhs + i));
+      __m256i r = _mm256_loadu_si256((const __m256i*)(rhs + i));
+      __m256i dif = _mm256_sub_epi32(l, r);
+      const unsigned generate = 
+          _mm256_movemask_ps(_mm256_castsi256_ps(dif));
+      const unsigned propagate = _mm256_movemask_ps(_mm256_castsi256_ps(
+          _mm256_cmpeq_epi32(dif, _mm256_setzero_si256())));
+      __m256i borrows = avx2CarryLanes(generate, propagate, borrow);
+      _mm256_storeu_si256((__m256i*)(res + i), 
+          _mm256_and_si256(_mm256_add_epi32(dif, borrows), limb_mask));
+    }
+    return i;
+}
+///the low halves of the products are added to the high halves of the 
+///products one lane below, which leaves a sum of two limbs per lane;
+///rhs must be less than k_Base, tmp receives what the scalar loop must carry
+///into the next limb
+__attribute__((target("avx2")))
+static size_type avx2SmallMult(const_pointer lhs, calc_type rhs, 
+                               pointer res, size_type len, wcalc_type &tmp)
+{
+    const __m256i limb_mask = _mm256_set1_epi32(k_Base - 1);
+    const __m256i factor = _mm256_set1_epi32(rhs);
+    const __m256i rotate = _mm256_setr_epi32(7, 0, 1, 2, 3, 4, 5, 6);
+    __m256i prev_high = _mm256_setzero_si256();
+    calc_type carry = 0;
+    size_type i = 0;
+    for (; i + 8 <= len; i += 8) {
+      __m256i l = _mm256_loadu_si256((const __m256i*)(lhs + i));
+      __m256i even = _mm256_mul_epu32(l, factor);
+      __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(l, 32), factor);
+      __m256i low = _mm256_and_si256(limb_mask, 
+          _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xAA));
+      __m256i high = _mm256_blend_epi32(
+          _mm256_srli_epi64(even, k_BaseBinDigit), 
+          _mm256_slli_epi64(_mm256_srli_epi64(odd, k_BaseBinDigit), 32), 
+          0xAA);
+      high = _mm256_permutevar8x32_epi32(high, rotate);
+      __m256i sum = _mm256_add_epi32(low, 
+          _mm256_blend_epi32(high, prev_high, 0x01));
+      prev_high = high;
+      _mm256_storeu_si256((__m256i*)(res + i), avx2Normalize(sum, carry));
+    }
+    tmp = wcalc_type(base_type(_mm256_cvtsi256_si32(prev_high))) + carry;
+    return i;
+}
+#else
+static size_type avx2Add(const_pointer, const_pointer, 
+                         pointer, size_type, calc_type&)
+{ return 0; }
+static size_type avx2Sub(const_pointer, const_pointer, 
+                         pointer, size_type, calc_type&)
+{ return 0; }
+static size_type avx2SmallMult(const_pointer, calc_type, 
+                               pointer, size_type, wcalc_type&)
+{ return 0; }
+#endif
+
 ///unsafe functions assume capacity is sufficient
 ///these functions store the result to the array pointed by res and return the number of elements stored
 ///res may point to lhs or rhs and that's okay
@@ -109,7 +278,10 @@ static size_type unsafeAdd(SegView lhs, SegView rhs, pointer res)
 {
     if(lhs.size() < rhs.size()) return unsafeAdd(rhs, lhs, res);
     calc_type tmp = 0, carry = 0;
-    for (size_type i = 0; i < lhs.size(); ++i) {
+    size_type i = 0;
+    if (useSimd(rhs.size())) 
+      i = avx2Add(lhs.cdata(), rhs.cdata(), res, rhs.size(), carry);
+    for (; i < lhs.size(); ++i) {
       tmp = lhs[i] + carry;
       if (i < rhs.size()) tmp += rhs[i];
       carry = tmp >> k_BaseBinDigit;
@@ -124,7 +296,10 @@ static size_type unsafeSub(SegView lhs, SegView rhs, pointer res)
     if (lhs.size() < rhs.size())
       n_Int::throw_unsigned_integer_underflow_exception();
     calc_type tmp = 0, carry = 0;
-    for (size_type i = 0; i < lhs.size(); ++i) {
+    size_type i = 0;
+    if (useSimd(rhs.size())) 
+      i = avx2Sub(lhs.cdata(), rhs.cdata(), res, rhs.size(), carry);
+    for (; i < lhs.size(); ++i) {
       tmp = k_Base + lhs[i] - carry;
       if (i < rhs.size()) tmp -= rhs[i];
       carry = !(tmp >> k_BaseBinDigit);
@@ -139,7 +314,10 @@ static size_type unsafeSmallMult(SegView lhs, calc_type rhs, pointer res)
 {
     if (rhs == 0) return 0;
     wcalc_type tmp = 0, r = rhs;
-    for (size_type i = 0; i < lhs.size(); ++i) {
+    size_type i = 0;
+    if (useSimd(lhs.size())) 
+      i = avx2SmallMult(lhs.cdata(), rhs, res, lhs.size(), tmp);
+    for (; i < lhs.size(); ++i) {
       tmp += r * lhs[i];
       res[i] = tmp & (k_Base - 1);
       tmp >>= k_BaseBinDigit;
@@ -165,21 +343,30 @@ unsafeSmallDivMod(SegView lhs, wcalc_type rhs,
 static size_type unsafeAnd(SegView lhs, SegView rhs, pointer res)
 {
     if(lhs.size() > rhs.size()) return unsafeAnd(rhs, lhs, res);
-    for (size_type i = 0; i < lhs.size(); ++i)
+    size_type i = 0;
+    if (useSimd(lhs.size())) 
+      i = avx2Bitwise<'&'>(lhs.cdata(), rhs.cdata(), res, lhs.size());
+    for (; i < lhs.size(); ++i)
       res[i] = lhs[i] & rhs[i]; 
     return trimZero(res, lhs.size());
 }
 static size_type unsafeOr(SegView lhs, SegView rhs, pointer res)
 {
     if(lhs.size() < rhs.size()) return unsafeOr(rhs, lhs, res);
-    for (size_type i = 0; i < lhs.size(); ++i)
+    size_type i = 0;
+    if (useSimd(rhs.size())) 
+      i = avx2Bitwise<'|'>(lhs.cdata(), rhs.cdata(), res, rhs.size());
+    for (; i < lhs.size(); ++i)
       res[i] = lhs[i] | (i < rhs.size() ? rhs[i] : 0); 
     return lhs.size();
 }
 static size_type unsafeXor(SegView lhs, SegView rhs, pointer res)
 {
     if(lhs.size() < rhs.size()) return unsafeXor(rhs, lhs, res);
-    for (size_type i = 0; i < lhs.size(); ++i)
+    size_type i = 0;
+    if (useSimd(rhs.size())) 
+      i = avx2Bitwise<'^'>(lhs.cdata(), rhs.cdata(), res, rhs.size());
+    for (; i < lhs.size(); ++i)
       res[i] = lhs[i] ^ (i < rhs.size() ? rhs[i] : 0); 
     return trimZero(res, lhs.size());
 }
@@ -187,7 +374,7 @@ static size_type unsafeShr(SegView lhs, size_t rhs, pointer res)
 {
     if (rhs < 0) throw std::invalid_argument("invalid argument");
     auto dec = decompose(rhs);
-    if(lhs.size() < dec.unit) {}
+    if(lhs.size() <= dec.unit) {}
     else if (dec.digit == 0) {
       if(dec.unit || (lhs.cdata() != res))
         std::copy_n(lhs.cdata() + dec.unit, lhs.size() - dec.unit, res);
@@ -206,10 +393,11 @@ static size_type unsafeShl(SegView lhs, size_t rhs, pointer res)
 {
     if (rhs < 0) throw std::invalid_argument("invalid argument");
     auto dec = decompose(rhs);
-    zeroFill(res, dec.unit);
+    ///the limbs are written from the top so that res may alias lhs
     if (dec.digit == 0) {
       if(dec.unit || (lhs.cdata() != res))
-        std::copy_n(lhs.cdata(), lhs.size(), res + dec.unit);
+        std::copy_backward(lhs.cdata(), lhs.cdata() + lhs.size(), 
+                           res + lhs.size() + dec.unit);
     }
     else {
       res[lhs.size() + dec.unit] = 0;
@@ -219,9 +407,61 @@ static size_type unsafeShl(SegView lhs, size_t rhs, pointer res)
         res[i + dec.unit] = (lhs[i] << dec.digit) & (k_Base - 1);
       }
     }
+    zeroFill(res, dec.unit);
     return trimZero(res, maxShlSize(lhs.size(), rhs));
 }
 
+///adds val * k_Base^offset to the array pointed by res, propagating the carry
+///the array must be large enough to hold the sum
+static void unsafeAddShifted(pointer res, SegView val, size_type offset)
+{
+    calc_type carry = 0;
+    res += offset;
+    for (size_type i = 0; i < val.size() || carry; ++i) {
+      calc_type tmp = res[i] + carry;
+      if (i < val.size()) tmp += val[i];
+      carry = tmp >> k_BaseBinDigit;
+      res[i] = tmp & (k_Base - 1);
+    }
+}
+
+
+///the small divisor reciprocal needs the high half of a 64 by 64 bit product, 
+///with wide limbs the remainder steps do not fit in 64 bits 
+///so the hardware division is used instead
+#if defined(__SIZEOF_INT128__) && !ACHIBULUP__BIGNUM_WIDE_LIMB
+static constexpr bool k_SmallReciprocal = true;
+static std::uint64_t mulHigh(std::uint64_t lhs, std::uint64_t rhs)
+{
+    return (unsigned __int128)lhs * rhs >> 64;
+}
+#else
+static constexpr bool k_SmallReciprocal = false;
+static std::uint64_t mulHigh(std::uint64_t, std::uint64_t) { return 0; }
+#endif
+
+///Montgomery reduction, t holds 2 * m.size() + 1 elements and a value less 
+///than m * k_Base^m.size(), the upper m.size() + 1 elements then hold 
+///t * k_Base^-m.size() modulo m, plus m at most once
+static void unsafeMontgomeryReduce(pointer t, SegView m, base_type inverse)
+{
+    const size_type len = m.size();
+    for (size_type i = 0; i < len; ++i) {
+      wcalc_type factor = (t[i] * wcalc_type(inverse)) & (k_Base - 1);
+      wcalc_type carry = 0;
+      for (size_type j = 0; j < len; ++j) {
+        carry += factor * m[j] + t[i + j];
+        t[i + j] = carry & (k_Base - 1);
+        carry >>= k_BaseBinDigit;
+      }
+      for (size_type j = i + len; carry; ++j) {
+        carry += t[j];
+        t[j] = carry & (k_Base - 1);
+        carry >>= k_BaseBinDigit;
+      }
+    }
+}
+
 
 static bool exceedThreshold(size_type size1, size_type size2)
 {
@@ -229,80 +469,742 @@ static bool exceedThreshold(size_type size1, size_type size2)
     return !(threshold / size2 >= size2);
 }
 
+///schoolbook product, stores exactly lhs.size() + rhs.size() elements
+static void unsafeBasecaseMul(SegView lhs, SegView rhs, pointer res)
+{
+    zeroFill(res, lhs.size());
+    for (size_type i = 0; i < rhs.size(); ++i) {
+      wcalc_type tmp = 0;
+      wcalc_type cur_digit = rhs[i];
+      for (size_type j = 0; j < lhs.size(); ++j) {
+        tmp += lhs[j] * cur_digit + res[j + i];
+        res[j + i] = tmp & (k_Base - 1);
+        tmp >>= k_BaseBinDigit;
+      }
+      res[lhs.size() + i] = tmp;
+    }
+}
+
+///res[0, len) += lhs * digit modulo k_Base^len, returns whether it wrapped
+static bool unsafeAddMulRow(SegView lhs, wcalc_type digit, 
+                            pointer res, size_type len)
+{
+    wcalc_type carry = 0;
+    for (size_type j = 0; j < lhs.size(); ++j) {
+      carry += lhs[j] * digit + res[j];
+      res[j] = carry & (k_Base - 1);
+      carry >>= k_BaseBinDigit;
+    }
+    for (size_type j = lhs.size(); carry != 0 && j < len; ++j) {
+      carry += res[j];
+      res[j] = carry & (k_Base - 1);
+      carry >>= k_BaseBinDigit;
+    }
+    return carry != 0;
+}
+///res[0, len) -= lhs * digit modulo k_Base^len, returns whether it wrapped
+static bool unsafeSubMulRow(SegView lhs, wcalc_type digit, 
+                            pointer res, size_type len)
+{
+    wcalc_type borrow = 0;
+    for (size_type j = 0; j < lhs.size(); ++j) {
+      borrow += lhs[j] * digit;
+      const calc_type tmp = k_Base + res[j] - (borrow & (k_Base - 1));
+      res[j] = tmp & (k_Base - 1);
+      borrow = (borrow >> k_BaseBinDigit) + !(tmp >> k_BaseBinDigit);
+    }
+    for (size_type j = lhs.size(); borrow != 0 && j < len; ++j) {
+      const calc_type tmp = k_Base + res[j] - calc_type(borrow);
+      res[j] = tmp & (k_Base - 1);
+      borrow = !(tmp >> k_BaseBinDigit);
+    }
+    return borrow != 0;
+}
+///res[0, len) +/-= lhs * rhs modulo k_Base^len without a product buffer,
+///len >= lhs.size() + rhs.size(), returns whether it wrapped
+static bool unsafeAddMul(SegView lhs, SegView rhs, pointer res, 
+                         size_type len, bool subtract)
+{
+    bool wrapped = false;
+    if (subtract)
+      for (size_type i = 0; i < rhs.size(); ++i)
+        wrapped |= unsafeSubMulRow(lhs, rhs[i], res + i, len - i);
+    else
+      for (size_type i = 0; i < rhs.size(); ++i)
+        wrapped |= unsafeAddMulRow(lhs, rhs[i], res + i, len - i);
+    return wrapped;
+}
+///res = k_Base^len - res, the magnitude of a wrapped difference
+static void unsafeNegate(pointer res, size_type len)
+{
+    size_type i = 0;
+    while (i < len && res[i] == 0) ++i;
+    if (i == len) return;
+    res[i] = k_Base - res[i];
+    for (++i; i < len; ++i)
+      res[i] = k_Base - 1 - res[i];
+}
+
+///number of scratch elements needed by unsafeKaratsubaMul
+static size_type karatsubaScratchSize(size_type size1, size_type size2)
+{
+    if (size2 == 0 || !exceedThreshold(size1, size2)) return 0;
+    size_type half = (size1 + 1) / 2;
+    if (size2 <= half)
+      return size2 * 2 + std::max(karatsubaScratchSize(size2, size2), 
+                                  karatsubaScratchSize(size2, size1 % size2));
+    return std::max({karatsubaScratchSize(half, half),
+                     karatsubaScratchSize(size1 - half, size2 - half),
+                     half * 4 + 4 + karatsubaScratchSize(half + 1, half + 1)});
+}
+
+///true when both views refer to the same limbs, 
+///their product is then computed by the squaring kernels
+static bool isSameView(SegView lhs, SegView rhs)
+{
+    return lhs.cdata() == rhs.cdata() && lhs.size() == rhs.size();
+}
+
+///schoolbook square, stores exactly x.size() * 2 elements
+///each cross product is computed once and then doubled
+static void unsafeBasecaseSqr(SegView x, pointer res)
+{
+    const size_type len = x.size();
+    zeroFill(res, len * 2);
+    for (size_type i = 0; i < len; ++i) {
+      wcalc_type tmp = 0;
+      wcalc_type cur_digit = x[i];
+      for (size_type j = i + 1; j < len; ++j) {
+        tmp += x[j] * cur_digit + res[j + i];
+        res[j + i] = tmp & (k_Base - 1);
+        tmp >>= k_BaseBinDigit;
+      }
+      res[len + i] = tmp;
+    }
+    wcalc_type carry = 0;
+    for (size_type i = 0; i < len; ++i) {
+      wcalc_type diag = wcalc_type(x[i]) * x[i];
+      carry += (wcalc_type(res[i * 2]) << 1) + (diag & (k_Base - 1));
+      res[i * 2] = carry & (k_Base - 1);
+      carry >>= k_BaseBinDigit;
+      carry += (wcalc_type(res[i * 2 + 1]) << 1) + (diag >> k_BaseBinDigit);
+      res[i * 2 + 1] = carry & (k_Base - 1);
+      carry >>= k_BaseBinDigit;
+    }
+}
+
+///Karatsuba square, stores exactly x.size() * 2 elements,
+///scratch must hold karatsubaScratchSize(x.size(), x.size()) elements
+static void unsafeKaratsubaSqr(SegView x, pointer res, pointer scratch)
+{
+    if (!exceedThreshold(x.size(), x.size()))
+      return unsafeBasecaseSqr(x, res);
+    const size_type half = (x.size() + 1) / 2;
+    SegView half1(x, 0, half), half2(x, half);
+    unsafeKaratsubaSqr(half1, res, scratch);
+    unsafeKaratsubaSqr(half2, res + half * 2, scratch);
+
+    pointer sum = scratch, mid = sum + (half + 1);
+    unsafeAdd(half1, half2, sum);
+    unsafeKaratsubaSqr(SegView(sum, half + 1), mid, mid + (half * 2 + 2));
+    ///mid = (x1 + x2)^2 - x1^2 - x2^2 = 2 * x1 * x2
+    size_type mid_size = unsafeSub(SegView(mid, half * 2 + 2), 
+                                   SegView(res, half * 2), mid);
+    mid_size = unsafeSub(SegView(mid, mid_size), 
+                         SegView(res + half * 2, trimZero(res + half * 2, 
+                                 x.size() * 2 - half * 2)), mid);
+    unsafeAddShifted(res, SegView(mid, mid_size), half);
+}
+
+///the scratch buffer Karatsuba stays ahead of Toom-Cook up to the NTT
+///threshold, Toom-Cook only splits the operands too large for NTT
+static constexpr size_type k_Toom3Threshold = 2000;
+static constexpr size_type k_Toom4Threshold = 2000;
+
+///Toom-Cook splits both operands into the same number of parts,
+///so it's only worth it when they have comparable sizes
+static bool useToomCook(size_type size1, size_type size2, int parts)
+{
+    size_type threshold = parts == 3 ? k_Toom3Threshold : k_Toom4Threshold;
+    return size2 >= threshold && size2 * parts > size1 * (parts - 1);
+}
+
+///the evaluation points of Toom-Cook: 0, 1, -1, 2, -2, 3...
+static constexpr long toomPoint(int idx)
+{
+    return idx % 2 ? (idx + 1) / 2 : -(idx / 2);
+}
+
+
+static constexpr size_type k_RecursiveDivThreshold = 40;
+
+static bool useRecursiveDivision(size_type divident_size, size_type divisor_size)
+{
+    return divisor_size >= k_RecursiveDivThreshold 
+        && divident_size - divisor_size >= k_RecursiveDivThreshold;
+}
+
+///below this size the gcd only uses Lehmer steps
+static constexpr size_type k_HalfGcdThreshold = 100;
+
+///bit r is set if r is a square modulo mod, mod <= 64
+static constexpr std::uint64_t squareResidues(unsigned mod, unsigned i = 0)
+{
+    return i == mod ? 0 : (std::uint64_t(1) << (i * i % mod)) 
+                          | squareResidues(mod, i + 1);
+}
+
+///the limbs from \a start upward
+static SegView highPart(SegView x, size_type start)
+{
+    return SegView(x, std::min(start, x.size()));
+}
+///the lowest \a len limbs, without leading zeros
+static SegView lowPart(SegView x, size_type len)
+{
+    return SegView(x.cdata(), trimZero(x.cdata(), std::min(len, x.size())));
+}
+
+///in limbs, or as many blocks of k_ioDecDigit digits
+static constexpr size_type k_ioRecursiveThreshold = 50;
+
+///the worker threads of the parallel multiplication, 
+///the thread that starts a batch takes tasks from it too, so a task may 
+///start nested batches without waiting on a worker that is blocked itself
+class ThreadPool
+{
+  public:
+    static ThreadPool& instance()
+    {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    ~ThreadPool()
+    {
+        this->resize(1);
+    }
+
+    unsigned size() const noexcept
+    {
+        return this->m_size;
+    }
+
+    void resize(unsigned count)
+    {
+        std::lock_guard<std::mutex> resize_lock(this->m_resize_mutex);
+        {
+          std::lock_guard<std::mutex> lock(this->m_mutex);
+          this->m_stop = true;
+        }
+        this->m_wake.notify_all();
+        for (std::thread &worker : this->m_workers) worker.join();
+        this->m_workers.clear();
+        {
+          ///the batches still queued are finished by the threads that started them
+          std::lock_guard<std::mutex> lock(this->m_mutex);
+          this->m_queue.clear();
+          this->m_stop = false;
+        }
+        this->m_size = std::max(count, 1u);
+        for (unsigned i = 1; i < this->m_size; ++i)
+          this->m_workers.emplace_back([this] { this->workerLoop(); });
+    }
+
+    ///calls func(i) for every i in [0, count), the calls may run concurrently,
+    ///the first exception thrown is rethrown once they have all returned
+    void run(size_type count, const std::function<void(size_type)> &func)
+    {
+        if (count <= 1 || this->size() <= 1) {
+          for (size_type i = 0; i < count; ++i) func(i);
+          return;
+        }
+        auto batch = std::make_shared<Batch>(func, count);
+        {
+          std::lock_guard<std::mutex> lock(this->m_mutex);
+          for (size_type i = std::min<size_type>(count, this->size()); i-- > 1;)
+            this->m_queue.push_back(batch);
+        }
+        this->m_wake.notify_all();
+        work(*batch);
+        std::unique_lock<std::mutex> lock(batch->mutex);
+        batch->finished.wait(lock, [&] { return batch->done == count; });
+        if (batch->error) std::rethrow_exception(batch->error);
+    }
+
+  private:
+    struct Batch
+    {
+        Batch(const std::function<void(size_type)> &f, size_type c) 
+        : func(f), count(c) {}
+
+        ///refers to the caller's function, which outlives the batch's tasks
+        const std::function<void(size_type)> &func;
+        const size_type count;
+        std::atomic<size_type> next{0};
+        size_type done = 0;
+        std::exception_ptr error;
+        std::mutex mutex;
+        std::condition_variable finished;
+    };
+
+    ThreadPool() = default;
+
+    static void work(Batch &batch)
+    {
+        size_type finished = 0;
+        for (size_type i; (i = batch.next++) < batch.count; ++finished) {
+          try {
+            batch.func(i);
+          }
+          catch (...) {
+            std::lock_guard<std::mutex> lock(batch.mutex);
+            if (!batch.error) batch.error = std::current_exception();
+          }
+        }
+        if (finished == 0) return;
+        std::lock_guard<std::mutex> lock(batch.mutex);
+        batch.done += finished;
+        if (batch.done == batch.count) batch.finished.notify_all();
+    }
+
+    void workerLoop()
+    {
+        std::unique_lock<std::mutex> lock(this->m_mutex);
+        while (true) {
+          this->m_wake.wait(lock, [this] { 
+              return this->m_stop || !this->m_queue.empty(); });
+          if (this->m_stop) return;
+          std::shared_ptr<Batch> batch = std::move(this->m_queue.front());
+          this->m_queue.pop_front();
+          lock.unlock();
+          work(*batch);
+          lock.lock();
+        }
+    }
+
+    std::mutex m_resize_mutex;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::deque<std::shared_ptr<Batch>> m_queue;
+    std::vector<std::thread> m_workers;
+    bool m_stop = false;
+    std::atomic<unsigned> m_size{1};
+};
+
+///calls func(i) for every i in [0, count), 
+///on the thread pool if \a parallel and serially otherwise
+template<typename Func>
+static void parallelFor(size_type count, bool parallel, const Func &func)
+{
+    if (parallel && ThreadPool::instance().size() > 1)
+      ThreadPool::instance().run(count, func);
+    else for (size_type i = 0; i < count; ++i) 
+      func(i);
+}
+
+using ntt_type = std::uint_least32_t;
+using wntt_type = std::uint_least64_t;
+
+static constexpr ntt_type k_NttMod1 = 998244353;  /// 119 * 2^23 + 1
+static constexpr ntt_type k_NttMod2 = 167772161;  /// 5 * 2^25 + 1
+static constexpr ntt_type k_NttMod3 = 469762049;  /// 7 * 2^26 + 1
+static constexpr size_type k_NttMaxSize = size_type(1) << 23;
+static constexpr size_type k_NttThreshold = 2000;
+
+///the smallest transform whose stages are split across threads, 
+///and the number of butterflies given to each task
+static constexpr size_type k_ParallelNttSize = size_type(1) << 15;
+static constexpr size_type k_ParallelNttChunk = size_type(1) << 13;
+///the smallest Toom-Cook piece whose products are computed concurrently
+static constexpr size_type k_ParallelToomPiece = 2 * k_NttThreshold;
+
+///wide limbs are transformed as two digits each, so that the convolution
+///of the digits stays below the product of the three primes
+static constexpr int k_NttDigitPerLimb = k_BaseBinDigit > 30 ? 2 : 1;
+static constexpr int k_NttDigitBinDigit = k_BaseBinDigit / k_NttDigitPerLimb;
+static constexpr ntt_type k_NttDigitMask = (ntt_type(1) << k_NttDigitBinDigit) - 1;
+
+///the convolution of 30-bit digits is recovered from three primes by CRT,
+///which is exact as long as the product has at most 2^23 digits
+static bool useNtt(size_type size1, size_type size2)
+{
+    return size2 >= k_NttThreshold 
+        && (size1 + size2) * k_NttDigitPerLimb <= k_NttMaxSize;
+}
+
+static ntt_type nttDigit(SegView x, size_type idx)
+{
+    return ntt_type(x[idx / k_NttDigitPerLimb] 
+          >> (idx % k_NttDigitPerLimb * k_NttDigitBinDigit)) & k_NttDigitMask;
+}
+
+///arithmetics modulo a prime of the form c * 2^k + 1 with primitive root 3
+template<ntt_type Mod>
+struct NttField
+{
+    static ntt_type mul(ntt_type lhs, ntt_type rhs)
+    {
+        return wntt_type(lhs) * rhs % Mod;
+    }
+    static ntt_type power(ntt_type base, wntt_type exp)
+    {
+        ntt_type res = 1;
+        for (; exp; exp >>= 1) {
+          if (exp & 1) res = mul(res, base);
+          base = mul(base, base);
+        }
+        return res;
+    }
+    static ntt_type inverse(ntt_type x)
+    {
+        return power(x, Mod - 2);
+    }
+
+    ///in-place iterative transform, the size must be a power of 2
+    static void transform(std::vector<ntt_type> &a, bool invert)
+    {
+        const size_type len = a.size();
+        for (size_type i = 1, j = 0; i < len; ++i) {
+          size_type bit = len >> 1;
+          for (; j & bit; bit >>= 1) j ^= bit;
+          j ^= bit;
+          if (i < j) std::swap(a[i], a[j]);
+        }
+
+        ntt_type root = power(3, (Mod - 1) / len);
+        if (invert) root = inverse(root);
+        std::vector<ntt_type> roots(std::max<size_type>(len / 2, 1));
+        roots[0] = 1;
+        for (size_type i = 1; i < len / 2; ++i)
+          roots[i] = mul(roots[i - 1], root);
+
+        ///the butterflies of a stage are independent, 
+        ///each task takes a run of k_ParallelNttChunk of them
+        const bool parallel = len >= k_ParallelNttSize;
+        const size_type chunks = ceilDiv(len / 2, k_ParallelNttChunk);
+        for (size_type half = 1; half < len; half <<= 1) {
+          const size_type stride = len / (half * 2);
+          parallelFor(chunks, parallel, [&](size_type chunk) {
+            const size_type first = chunk * k_ParallelNttChunk;
+            const size_type last = std::min(first + k_ParallelNttChunk, len / 2);
+            for (size_type k = first; k < last;) {
+              const size_type begin = k & (half - 1), start = (k - begin) * 2;
+              const size_type end = std::min(half, begin + (last - k));
+              for (size_type j = begin; j < end; ++j) {
+                ntt_type u = a[start + j];
+                ntt_type v = mul(a[start + j + half], roots[j * stride]);
+                a[start + j] = u + v >= Mod ? u + v - Mod : u + v;
+                a[start + j + half] = u >= v ? u - v : u + Mod - v;
+              }
+              k += end - begin;
+            }
+          });
+        }
+
+        if (invert) {
+          ntt_type len_inv = inverse(len % Mod);
+          for (ntt_type &x : a) x = mul(x, len_inv);
+        }
+    }
+
+    ///cyclic convolution of the digits modulo Mod, len must be a power of 2
+    static std::vector<ntt_type> convolve(SegView lhs, SegView rhs, 
+                                          size_type len)
+    {
+        std::vector<ntt_type> fl(len), fr;
+        for (size_type i = 0; i < lhs.size() * k_NttDigitPerLimb; ++i) 
+          fl[i] = nttDigit(lhs, i) % Mod;
+        if (!isSameView(lhs, rhs)) {
+          fr.resize(len);
+          for (size_type i = 0; i < rhs.size() * k_NttDigitPerLimb; ++i) 
+            fr[i] = nttDigit(rhs, i) % Mod;
+        }
+        const bool parallel = len >= k_ParallelNttSize;
+        if (isSameView(lhs, rhs)) {
+          transform(fl, false);
+          for (size_type i = 0; i < len; ++i) fl[i] = mul(fl[i], fl[i]);
+        }
+        else {
+          parallelFor(2, parallel, [&](size_type idx) {
+            transform(idx == 0 ? fl : fr, false);
+          });
+          for (size_type i = 0; i < len; ++i) fl[i] = mul(fl[i], fr[i]);
+        }
+        transform(fl, true);
+        return fl;
+    }
+};
+
 } // namespace n_Int
 
 using namespace n_Int;
 
 
+void setMultiplicationThreads(unsigned count)
+{
+    ThreadPool::instance().resize(count);
+}
+unsigned multiplicationThreads() noexcept
+{
+    return ThreadPool::instance().size();
+}
+
+
+///Karatsuba product of lhs.size() >= rhs.size() > 0, 
+///stores exactly lhs.size() + rhs.size() elements, 
+///the temporaries of the whole recursion are carved out of scratch 
+///which must hold karatsubaScratchSize(lhs.size(), rhs.size()) elements
+void uInt::unsafeKaratsubaMul(SegView lhs, SegView rhs, 
+                              pointer res, pointer scratch)
+{
+    if (!exceedThreshold(lhs.size(), rhs.size()))
+      return unsafeBasecaseMul(lhs, rhs, res);
+    ///the pieces that Toom-Cook or NTT would take go there, 
+    ///those keep their own temporaries
+    if (useNtt(lhs.size(), rhs.size()) 
+     || useToomCook(lhs.size(), rhs.size(), 4)
+     || useToomCook(lhs.size(), rhs.size(), 3)) {
+      const uInt prod = doMul(lhs, rhs);
+      std::copy_n(prod.cdata(), prod.size(), res);
+      zeroFill(res + prod.size(), lhs.size() + rhs.size() - prod.size());
+      return;
+    }
+    const size_type half = (lhs.size() + 1) / 2;
+
+    if (rhs.size() <= half) {
+      zeroFill(res, lhs.size() + rhs.size());
+      pointer prod = scratch;
+      for (size_type start = 0; start < lhs.size(); start += rhs.size()) {
+        SegView piece(lhs, start, 
+                      std::min(rhs.size(), lhs.size() - start));
+        if (piece.size() >= rhs.size())
+          unsafeKaratsubaMul(piece, rhs, prod, scratch + rhs.size() * 2);
+        else unsafeKaratsubaMul(rhs, piece, prod, scratch + rhs.size() * 2);
+        unsafeAddShifted(res, SegView(prod, piece.size() + rhs.size()), 
+                         start);
+      }
+      return;
+    }
+
+    SegView lhalf1(lhs, 0, half), lhalf2(lhs, half);
+    SegView rhalf1(rhs, 0, half), rhalf2(rhs, half);
+    unsafeKaratsubaMul(lhalf1, rhalf1, res, scratch);
+    unsafeKaratsubaMul(lhalf2, rhalf2, res + half * 2, scratch);
+
+    pointer suml = scratch, sumr = suml + (half + 1);
+    pointer mid = sumr + (half + 1);
+    unsafeAdd(lhalf1, lhalf2, suml);
+    unsafeAdd(rhalf1, rhalf2, sumr);
+    unsafeKaratsubaMul(SegView(suml, half + 1), SegView(sumr, half + 1), 
+                       mid, mid + (half * 2 + 2));
+    ///mid = (l1 + l2)(r1 + r2) - l1 * r1 - l2 * r2 = l1 * r2 + l2 * r1
+    size_type mid_size = unsafeSub(SegView(mid, half * 2 + 2), 
+                                   SegView(res, half * 2), mid);
+    mid_size = unsafeSub(SegView(mid, mid_size), 
+                         SegView(res + half * 2, trimZero(res + half * 2, 
+                                 lhs.size() + rhs.size() - half * 2)), mid);
+    unsafeAddShifted(res, SegView(mid, mid_size), half);
+}
+
 /// Karatsuba algorithm
 uInt uInt::bigOrderedProduct(SegView lhs, SegView rhs)
 {
     uInt res(maxProdSize(lhs.size(), rhs.size()), 0);
-    size_type half = (lhs.size() + 1) / 2;
+    std::unique_ptr<base_type[]> scratch(
+        new base_type[karatsubaScratchSize(lhs.size(), rhs.size())]);
+    unsafeKaratsubaMul(lhs, rhs, res.data(), scratch.get());
+    res.size = n_Int::trimZero(res.data(), lhs.size() + rhs.size());
+    return res;
+}
 
-    if (rhs.size() <= half) {
-      uInt res1 = doMul(SegView(lhs, 0, half), rhs);
-      uInt res2 = doMul(SegView(lhs, half), rhs);
-      copy(res, res1);
-      res.size = res.capacity();
-      zeroFill(res.data() + res1.size(), res.size() - res1.size());
-      for (size_type i = 0; i < res2.size(); ++i)
-        if ((res[i + half] += res2[i]) >= k_Base) { 
-          res[i + half] -= k_Base;
-          ++res[i + half + 1];
-        }
-      res.size = n_Int::trimZero(res.data(), res.size());
+struct uInt::SignedTerm
+{
+    uInt abs;
+    bool negative;
+
+    static SignedTerm add(SignedTerm lhs, SignedTerm rhs)
+    {
+        if (lhs.negative == rhs.negative)
+          return {doAdd(std::move(lhs.abs), std::move(rhs.abs)), lhs.negative};
+        if (SegView(lhs.abs) < SegView(rhs.abs))
+          return {doSub(std::move(rhs.abs), lhs.abs), rhs.negative};
+        return {doSub(std::move(lhs.abs), rhs.abs), lhs.negative};
+    }
+    static SignedTerm sub(SignedTerm lhs, SignedTerm rhs)
+    {
+        rhs.negative = !rhs.negative;
+        return add(std::move(lhs), std::move(rhs));
+    }
+    static SignedTerm mul(const SignedTerm &lhs, const SignedTerm &rhs)
+    {
+        return {doMul(lhs.abs, rhs.abs), lhs.negative != rhs.negative};
+    }
+    static SignedTerm smallMul(const SignedTerm &lhs, long rhs)
+    {
+        uInt res(lhs.abs.size() + 1, 0);
+        res.size = unsafeSmallMult(lhs.abs, rhs < 0 ? -rhs : rhs, res.data());
+        return {std::move(res), lhs.negative != (rhs < 0)};
+    }
+    ///the division must be exact
+    static SignedTerm exactSmallDiv(SignedTerm lhs, long rhs)
+    {
+        lhs.abs.size = unsafeSmallDivMod(
+            lhs.abs, rhs < 0 ? -rhs : rhs, lhs.abs.data());
+        lhs.negative = lhs.negative != (rhs < 0);
+        return lhs;
     }
+};
 
-    else {
-      SegView lhalf1(lhs, 0, half), lhalf2(lhs, half);
-      SegView rhalf1(rhs, 0, half), rhalf2(rhs, half);
-      uInt suml = doAdd(lhalf1, lhalf2), sumr = doAdd(rhalf1, rhalf2);
-      uInt res1 = doMul(lhalf1, rhalf1);
-      uInt res2 = doMul(suml, sumr);
-      uInt res3 = doMul(lhalf2, rhalf2);
-      res2.size = unsafeSub(res2, res1, res2.data());
-      res2.size = unsafeSub(res2, res3, res2.data());
-
-      res.size = res.capacity();
-      calc_type tmp = 0, carry = 0;
-      for (size_type i = 0; i < res.size(); ++i) {
-        tmp = carry;
-        carry = 0;
-        if(i < res1.size()) 
-          tmp += res1[i];
-        if(half <= i && i < half + res2.size())
-          tmp += res2[i - half];
-        if(half * 2 <= i && i < half * 2 + res3.size())
-          tmp += res3[i - half * 2];
-        while (tmp >= k_Base) {
-          tmp -= k_Base;
-          ++carry;
-        }
-        res[i] = tmp;
+/// Toom-Cook algorithm
+/// the operands are split into \a parts pieces, evaluated at 2 * parts - 2 
+/// small points and infinity, then the product is interpolated back 
+/// with Newton's divided differences, which are exact for integer polynomials
+uInt uInt::toomCookProduct(SegView lhs, SegView rhs, int parts)
+{
+    const size_type piece = ceilDiv(lhs.size(), parts);
+    const int degree = 2 * parts - 2;
+    auto split = [piece](SegView x, int idx) {
+        size_type start = std::min(x.size(), piece * idx);
+        size_type len = std::min(x.size() - start, piece);
+        return SegView(x.cdata() + start, trimZero(x.cdata() + start, len));
+    };
+    auto evaluate = [&](SegView x, long point) {
+        if (point == 0) return SignedTerm{uInt(split(x, 0)), false};
+        SignedTerm res{uInt(split(x, parts - 1)), false};
+        for (int i = parts - 1; i-- > 0;)
+          res = SignedTerm::add(SignedTerm::smallMul(res, point), 
+                                SignedTerm{uInt(split(x, i)), false});
+        return res;
+    };
+
+    ///the pointwise products are independent, 
+    ///the last one is the product of the leading pieces
+    std::vector<SignedTerm> diff(degree + 1);
+    parallelFor(degree + 1, piece >= k_ParallelToomPiece, [&](size_type i) {
+      if (int(i) == degree) {
+        diff[i] = {doMul(split(lhs, parts - 1), split(rhs, parts - 1)), false};
+        return;
+      }
+      SignedTerm val = evaluate(lhs, toomPoint(i));
+      ///passing the same value twice lets doMul take the squaring path
+      diff[i] = isSameView(lhs, rhs) ? SignedTerm::mul(val, val)
+              : SignedTerm::mul(val, evaluate(rhs, toomPoint(i)));
+    });
+    SignedTerm leading = std::move(diff.back());
+    diff.pop_back();
+    for (int i = 0; i < degree; ++i) {
+      long point = toomPoint(i), power = 1;
+      for (int j = 0; j < degree; ++j) power *= point;
+      diff[i] = SignedTerm::sub(std::move(diff[i]), 
+                                SignedTerm::smallMul(leading, power));
+    }
+    for (int level = 1; level < degree; ++level)
+      for (int i = degree; i-- > level;)
+        diff[i] = SignedTerm::exactSmallDiv(
+            SignedTerm::sub(std::move(diff[i]), diff[i - 1]),
+            toomPoint(i) - toomPoint(i - level));
+
+    ///expand the Newton form into the coefficients, from the highest term
+    std::vector<SignedTerm> coef;
+    coef.reserve(degree + 1);
+    coef.push_back(std::move(diff[degree - 1]));
+    for (int i = degree - 1; i-- > 0;) {
+      long point = toomPoint(i);
+      coef.push_back(coef.back());
+      for (size_type j = coef.size() - 1; j-- > 1;)
+        coef[j] = SignedTerm::sub(coef[j - 1], 
+                                  SignedTerm::smallMul(coef[j], point));
+      coef[0] = SignedTerm::add(SignedTerm::smallMul(coef[0], -point),
+                                std::move(diff[i]));
+    }
+    coef.push_back(std::move(leading));
+
+    uInt res(maxProdSize(lhs.size(), rhs.size()), 0);
+    res.size = res.capacity();
+    zeroFill(res.data(), res.size());
+    for (int i = 0; i <= degree; ++i)
+      unsafeAddShifted(res.data(), coef[i].abs, piece * i);
+    res.size = n_Int::trimZero(res.data(), res.size());
+    return res;
+}
+
+/// number theoretic transform over three primes, combined with Garner's algorithm
+uInt uInt::nttProduct(SegView lhs, SegView rhs)
+{
+    using Field1 = NttField<k_NttMod1>;
+    using Field2 = NttField<k_NttMod2>;
+    using Field3 = NttField<k_NttMod3>;
+    const size_type conv_size = 
+        (lhs.size() + rhs.size()) * k_NttDigitPerLimb - 1;
+    size_type len = 1;
+    while (len < conv_size) len <<= 1;
+    ///the three convolutions are independent
+    std::vector<ntt_type> res1, res2, res3;
+    parallelFor(3, len >= k_ParallelNttSize, [&](size_type idx) {
+      if (idx == 0) res1 = Field1::convolve(lhs, rhs, len);
+      else if (idx == 1) res2 = Field2::convolve(lhs, rhs, len);
+      else res3 = Field3::convolve(lhs, rhs, len);
+    });
+
+    const ntt_type inv1 = Field2::inverse(k_NttMod1 % k_NttMod2);
+    const ntt_type inv12 = Field3::inverse(
+        Field3::mul(k_NttMod1 % k_NttMod3, k_NttMod2));
+    uInt res(maxProdSize(lhs.size(), rhs.size()), 0);
+    res.size = res.capacity();
+    zeroFill(res.data(), res.size());
+    wntt_type carry = 0;
+    for (size_type i = 0; i < res.size() * k_NttDigitPerLimb; ++i) {
+      if (i < conv_size) {
+        ///conv = a1 + mod1 * (a2 + mod2 * a3)
+        wntt_type a1 = res1[i];
+        wntt_type a2 = Field2::mul(
+            (res2[i] + k_NttMod2 - a1 % k_NttMod2) % k_NttMod2, inv1);
+        wntt_type a3 = Field3::mul(
+            (res3[i] + k_NttMod3 - (a1 + a2 * k_NttMod1) % k_NttMod3) 
+              % k_NttMod3, inv12);
+        wntt_type high = a2 + a3 * k_NttMod2;
+        carry += a1 + (high & k_NttDigitMask) * k_NttMod1;
+        res[i / k_NttDigitPerLimb] |= base_type(carry & k_NttDigitMask) 
+            << (i % k_NttDigitPerLimb * k_NttDigitBinDigit);
+        carry = (carry >> k_NttDigitBinDigit) 
+              + (high >> k_NttDigitBinDigit) * k_NttMod1;
+      }
+      else {
+        res[i / k_NttDigitPerLimb] |= base_type(carry & k_NttDigitMask) 
+            << (i % k_NttDigitPerLimb * k_NttDigitBinDigit);
+        carry >>= k_NttDigitBinDigit;
       }
-      res.size = n_Int::trimZero(res.data(), res.size());
     }
+    res.size = n_Int::trimZero(res.data(), res.size());
+    return res;
+}
 
+/// Karatsuba algorithm with three half-size squares
+uInt uInt::bigSquare(SegView x)
+{
+    uInt res(maxProdSize(x.size(), x.size()), 0);
+    std::unique_ptr<base_type[]> scratch(
+        new base_type[karatsubaScratchSize(x.size(), x.size())]);
+    unsafeKaratsubaSqr(x, res.data(), scratch.get());
+    res.size = n_Int::trimZero(res.data(), x.size() * 2);
+    return res;
+}
+/// schoolbook algorithm
+uInt uInt::smallSquare(SegView x)
+{
+    uInt res(maxProdSize(x.size(), x.size()), 0);
+    unsafeBasecaseSqr(x, res.data());
+    res.size = n_Int::trimZero(res.data(), x.size() * 2);
     return res;
 }
 
 /// schoolbook algorithm
 uInt uInt::smallOrderedProduct(SegView lhs, SegView rhs)
 {
-    uInt res(maxProdSize(lhs.size(), rhs.size()), lhs.size());
-    zeroFill(res.data(), lhs.size());
-    for (size_type i = 0; i < rhs.size(); ++i) {
-      wcalc_type tmp = 0;
-      wcalc_type cur_digit = rhs[i];
-      for (size_type j = 0; j < lhs.size(); ++j) {
-        tmp += lhs[j] * cur_digit + res[j + i];
-        res[j + i] = tmp & (k_Base - 1);
-        tmp >>= k_BaseBinDigit;
-      }
-      res.unsafePushBack(tmp);
-    }
-    res.size = n_Int::trimZero(res.data(), res.size());
+    uInt res(maxProdSize(lhs.size(), rhs.size()), 0);
+    unsafeBasecaseMul(lhs, rhs, res.data());
+    res.size = n_Int::trimZero(res.data(), lhs.size() + rhs.size());
     return res;
 }
 
@@ -404,6 +1306,15 @@ uInt& uInt::operator --() &
     return *this;
 }
 
+bool uInt::doEqual(SegView lhs, SegView rhs)
+{
+    return lhs == rhs;
+}
+bool uInt::doLess(SegView lhs, SegView rhs)
+{
+    return lhs < rhs;
+}
+
 uInt uInt::doAdd(SegView lhs, SegView rhs)
 {
     uInt res(maxSumSize(lhs.size(), rhs.size()), 0);
@@ -460,10 +1371,86 @@ uInt uInt::doSub(uInt &&lhs, uInt &&rhs)
 uInt uInt::doMul(SegView lhs, SegView rhs)
 {
     if(lhs.size() < rhs.size()) return doMul(rhs, lhs);
+    if (rhs.size() == 0) return uInt();
+    if (isSameView(lhs, rhs)) return doSqr(lhs);
+    if (useNtt(lhs.size(), rhs.size()))
+      return nttProduct(lhs, rhs);
+    if (useToomCook(lhs.size(), rhs.size(), 4))
+      return toomCookProduct(lhs, rhs, 4);
+    if (useToomCook(lhs.size(), rhs.size(), 3))
+      return toomCookProduct(lhs, rhs, 3);
     if (exceedThreshold(lhs.size(), rhs.size()))
       return bigOrderedProduct(lhs, rhs);
     return smallOrderedProduct(lhs, rhs);
 }
+bool uInt::doAddMul(uInt &dest, SegView lhs, SegView rhs, bool subtract)
+{
+    if (lhs.size() < rhs.size()) return doAddMul(dest, rhs, lhs, subtract);
+    if (rhs.size() == 0) return false;
+    if (exceedThreshold(lhs.size(), rhs.size())) {
+      uInt prod = doMul(lhs, rhs);
+      if (!subtract) {
+        dest.reserve(maxSumSize(dest.size(), prod.size()));
+        dest.size = unsafeAdd(dest, prod, dest.data());
+        return false;
+      }
+      if (!(dest < prod)) {
+        dest.size = unsafeSub(dest, prod, dest.data());
+        return false;
+      }
+      prod.size = unsafeSub(prod, dest, prod.data());
+      dest = std::move(prod);
+      return true;
+    }
+
+    ///an operand stored in dest would be overwritten before it's fully read
+    uInt lhs_copy, rhs_copy;
+    if (lhs.data() == dest.data()) {
+      lhs_copy = uInt(lhs);
+      lhs = lhs_copy;
+    }
+    if (rhs.data() == dest.data()) {
+      rhs_copy = uInt(rhs);
+      rhs = rhs_copy;
+    }
+    ///a sum never wraps with one more limb, a difference wraps exactly when
+    ///it's negative
+    const size_type len = std::max(dest.size(), maxProdSize(lhs.size(), rhs.size()))
+                        + !subtract;
+    dest.reserve(len);
+    zeroFill(dest.data() + dest.size(), len - dest.size());
+    const bool negative = unsafeAddMul(lhs, rhs, dest.data(), len, subtract);
+    if (negative) unsafeNegate(dest.data(), len);
+    dest.size = trimZero(dest.data(), len);
+    return negative;
+}
+void submul(uInt &dest, const uInt &lhs, const uInt &rhs)
+{
+    if (&dest == &lhs || &dest == &rhs) {
+      uInt res = dest;
+      submul(res, lhs, rhs);
+      dest = std::move(res);
+      return;
+    }
+    if (uInt::doAddMul(dest, lhs, rhs, true)) {
+      ///|(p - d) - p| == d
+      uInt::doAddMul(dest, lhs, rhs, true);
+      n_Int::throw_unsigned_integer_underflow_exception();
+    }
+}
+uInt uInt::doSqr(SegView x)
+{
+    if (x.size() == 0) return uInt();
+    if (useNtt(x.size(), x.size()))
+      return nttProduct(x, x);
+    if (useToomCook(x.size(), x.size(), 4))
+      return toomCookProduct(x, x, 4);
+    if (useToomCook(x.size(), x.size(), 3))
+      return toomCookProduct(x, x, 3);
+    if (exceedThreshold(x.size(), x.size()))
+      return bigSquare(x);
+    return smallSquare(x);
+}
 uInt uInt::doDiv(SegView divident, const uInt &divisor)
 {
     if (divisor.size() == 0) 
@@ -495,8 +1482,80 @@ uIntDivResult uInt::doDivMod(SegView divident, const uInt &divisor)
       return uIntDivResult{
           uInt::smallDiv(divident, uInt::downCast(divisor)),
           uInt::smallMod(divident, uInt::downCast(divisor))};
+    if (!useRecursiveDivision(divident.size(), divisor.size()))
+      return schoolbookDivMod(divident, divisor);
+
+    /*else*/ /*normalize so that the divisor's most significant bit is set*/
+    int shift = k_BaseBinDigit - int(SegView(divisor.back()).digitCount());
+    uInt lhs(maxShlSize(divident.size(), shift), 0);
+    lhs.size = unsafeShl(divident, shift, lhs.data());
+    uInt rhs(maxShlSize(divisor.size(), shift), 0);
+    rhs.size = unsafeShl(divisor, shift, rhs.data());
 
-    /*else*/ /*school-book algorithm*/
+    /// the quotient is computed in blocks of rhs.size() limbs,
+    /// each one being a balanced recursive division
+    const size_type block = rhs.size();
+    size_type pos = lhs.size() - block;
+    uInt quo(pos + 1, pos + 1);
+    zeroFill(quo.data(), quo.size());
+    size_type first_block = (pos - 1) % block + 1;
+    pos -= first_block;
+    uInt rem(SegView(lhs, pos));
+    if (SegView(rem, first_block) >= rhs) {
+      quo[pos + first_block] = 1;
+      rem.size = unsafeSub(rem, addShifted(rhs, first_block, SegView(nullptr, 0)), 
+                           rem.data());
+    }
+    while (true) {
+      uIntDivResult cur = recursiveDivMod(rem, rhs);
+      unsafeAddShifted(quo.data(), cur.quo, pos);
+      rem = std::move(cur.rem);
+      if (pos == 0) break;
+      pos -= block;
+      rem = addShifted(rem, block, lowPart(SegView(lhs, pos), block));
+    }
+    quo.size = trimZero(quo.data(), quo.size());
+    return uIntDivResult{std::move(quo), doShr(std::move(rem), shift)};
+}
+
+/// Burnikel-Ziegler style recursion, from Brent & Zimmermann's RecursiveDivRem
+/// the divisor must be normalized 
+/// and the quotient must fit in lhs.size() - rhs.size() limbs
+uIntDivResult uInt::recursiveDivMod(SegView lhs, SegView rhs)
+{
+    if (lhs < rhs) 
+      return uIntDivResult{uInt(), uInt(lhs)};
+    const size_type len = lhs.size() - rhs.size();
+    if (len < k_RecursiveDivThreshold)
+      return schoolbookDivMod(lhs, uInt(rhs));
+
+    const size_type half = len / 2;
+    SegView rhs_high(rhs, half), rhs_low = lowPart(rhs, half);
+
+    uIntDivResult high = recursiveDivMod(SegView(lhs, half * 2), rhs_high);
+    uInt cur = addShifted(high.rem, half * 2, lowPart(lhs, half * 2));
+    uInt sub = addShifted(doMul(high.quo, rhs_low), half, SegView(nullptr, 0));
+    while (SegView(cur) < SegView(sub)) {
+      --high.quo;
+      cur = addShifted(rhs, half, cur);
+    }
+    cur.size = unsafeSub(cur, sub, cur.data());
+
+    uIntDivResult low = recursiveDivMod(highPart(cur, half), rhs_high);
+    uInt rem = addShifted(low.rem, half, lowPart(cur, half));
+    sub = doMul(low.quo, rhs_low);
+    while (SegView(rem) < SegView(sub)) {
+      --low.quo;
+      rem = addShifted(rhs, 0, rem);
+    }
+    rem.size = unsafeSub(rem, sub, rem.data());
+
+    return uIntDivResult{addShifted(high.quo, half, low.quo), std::move(rem)};
+}
+
+/// school-book algorithm
+uIntDivResult uInt::schoolbookDivMod(SegView divident, const uInt &divisor)
+{
     uInt::size_type quotient_max_size = divident.size() - divisor.size() + 1;
     uIntDivResult res = {uInt{quotient_max_size, quotient_max_size},
                       uInt{divisor.size() + 1, divisor.size() - 1}};
@@ -550,9 +1609,9 @@ uInt uInt::doOr(const uInt &lhs, const uInt &rhs)
 }
 uInt uInt::doOr(const uInt &lhs, uInt &&rhs)
 {
-    if (lhs.data() == rhs.data() 
-     || rhs.capacity() < maxOrSize(lhs.size(), rhs.size()))
-      return lhs;
+    if (lhs.data() == rhs.data()) return lhs;
+    if (rhs.capacity() < maxOrSize(lhs.size(), rhs.size()))
+      return doOr(lhs, rhs);
     rhs.size = unsafeOr(lhs, rhs, rhs.data());
     return std::move(rhs);
 }
@@ -607,7 +1666,115 @@ uInt uInt::doShl(uInt &&lhs, int rhs)
     return std::move(lhs);
 }
 
-
+///rhs may view lhs itself, it is viewed again after the reserve
+void uInt::doAddAssign(uInt &lhs, SegView rhs)
+{
+    const bool aliased = rhs.data() == lhs.data();
+    lhs.reserve(maxSumSize(lhs.size(), rhs.size()));
+    lhs.size = unsafeAdd(lhs, aliased ? SegView(lhs) : rhs, lhs.data());
+}
+void uInt::doAddAssign(uInt &lhs, uInt &&rhs)
+{
+    if (lhs.capacity() < maxSumSize(lhs.size(), rhs.size())) lhs.swap(rhs);
+    doAddAssign(lhs, rhs);
+}
+void uInt::doSubAssign(uInt &lhs, SegView rhs)
+{
+    ///checked first so that lhs is left intact
+    if (SegView(lhs) < rhs) throw_unsigned_integer_underflow_exception();
+    lhs.size = unsafeSub(lhs, rhs, lhs.data());
+}
+void uInt::doReverseSubAssign(uInt &lhs, SegView rhs)
+{
+    if (rhs < SegView(lhs)) throw_unsigned_integer_underflow_exception();
+    const bool aliased = rhs.data() == lhs.data();
+    lhs.reserve(maxDifSize(rhs.size(), lhs.size()));
+    lhs.size = unsafeSub(aliased ? SegView(lhs) : rhs, lhs, lhs.data());
+}
+void uInt::doAndAssign(uInt &lhs, const uInt &rhs)
+{
+    lhs.size = unsafeAnd(lhs, rhs, lhs.data());
+}
+void uInt::doOrAssign(uInt &lhs, const uInt &rhs)
+{
+    lhs.reserve(maxOrSize(lhs.size(), rhs.size()));
+    lhs.size = unsafeOr(lhs, rhs, lhs.data());
+}
+void uInt::doOrAssign(uInt &lhs, uInt &&rhs)
+{
+    if (lhs.capacity() < maxOrSize(lhs.size(), rhs.size())) lhs.swap(rhs);
+    doOrAssign(lhs, rhs);
+}
+void uInt::doXorAssign(uInt &lhs, const uInt &rhs)
+{
+    lhs.reserve(maxXorSize(lhs.size(), rhs.size()));
+    lhs.size = unsafeXor(lhs, rhs, lhs.data());
+}
+void uInt::doXorAssign(uInt &lhs, uInt &&rhs)
+{
+    if (lhs.capacity() < maxXorSize(lhs.size(), rhs.size())) lhs.swap(rhs);
+    doXorAssign(lhs, rhs);
+}
+void uInt::doShlAssign(uInt &lhs, int rhs)
+{
+    lhs.reserve(maxShlSize(lhs.size(), rhs));
+    lhs.size = unsafeShl(lhs, rhs, lhs.data());
+}
+void uInt::doShrAssign(uInt &lhs, int rhs)
+{
+    lhs.size = unsafeShr(lhs, rhs, lhs.data());
+}
+
+///whether unsafeSmallDivMod can divide by val without overflowing
+static bool fitsSmallDivisor(std::uintmax_t val)
+{
+    constexpr int k_Digits = std::numeric_limits<std::uintmax_t>::digits;
+    return k_SmallDivisorBinDigit >= k_Digits 
+        || val < std::uintmax_t(1) << k_SmallDivisorBinDigit % k_Digits;
+}
+uInt uInt::nativeMul(SegView lhs, std::uintmax_t rhs)
+{
+    if (rhs >= k_Base)
+      return doMul(lhs, NativeLimbs(rhs));
+    uInt res(lhs.size() + 1, 0);
+    res.size = unsafeSmallMult(lhs, rhs, res.data());
+    return res;
+}
+uInt uInt::nativeDiv(SegView lhs, std::uintmax_t rhs)
+{
+    if (rhs == 0)
+      throw_division_by_zero_exception();
+    if (fitsSmallDivisor(rhs))
+      return smallDiv(lhs, rhs);
+    return doDiv(lhs, uInt(rhs));
+}
+uInt uInt::nativeMod(SegView lhs, std::uintmax_t rhs)
+{
+    if (rhs == 0)
+      throw_division_by_zero_exception();
+    if (fitsSmallDivisor(rhs))
+      return smallMod(lhs, rhs);
+    return doMod(lhs, uInt(rhs));
+}
+void uInt::nativeMulAssign(uInt &lhs, std::uintmax_t rhs)
+{
+    if (rhs >= k_Base) {
+      lhs = doMul(lhs, NativeLimbs(rhs));
+      return;
+    }
+    lhs.reserve(lhs.size() + 1);
+    lhs.size = unsafeSmallMult(lhs, rhs, lhs.data());
+}
+void uInt::nativeDivAssign(uInt &lhs, std::uintmax_t rhs)
+{
+    if (rhs == 0)
+      throw_division_by_zero_exception();
+    if (fitsSmallDivisor(rhs))
+      lhs.size = unsafeSmallDivMod(lhs, rhs, lhs.data());
+    else lhs = doDiv(lhs, uInt(rhs));
+}
+
+
 uInt& uInt::parse(string_view strv) &
 {
     const char *str = strv.data();
@@ -616,6 +1783,8 @@ uInt& uInt::parse(string_view strv) &
     { ++str; --len; }
     if (len == 0) 
     { this->clear(); return *this; }
+    if (len > k_ioRecursiveThreshold * k_ioDecDigit)
+      return *this = fromDecimal(str, len);
 
     size_type estimate_size = 
       std::ceil((std::log2(ten) / k_BaseBinDigit + .00001) * len);
@@ -637,28 +1806,535 @@ uInt& uInt::parse(string_view strv) &
 
 std::string uInt::toString() &&
 {
-    if (!*this) return "0";
     std::string res;
-    while (*this) {
-      wcalc_type first;
-      this->size = unsafeSmallDivMod(
-          *this, k_ioUnit, this->data(), &first);
-      calc_type unit = first;
-      if (*this) 
-        for (int i = 0; i < k_ioDecDigit; ++i) {
-          res.push_back('0' + unit % ten);
-          unit /= ten;
+    res.reserve(this->toCharsBound());
+    auto sink = [&res](const char *digits, size_type count) {
+        res.append(digits, count);
+    };
+    writeDecimal(std::move(*this), sink);
+    return res;
+}
+
+std::size_t uInt::toCharsBound() const noexcept
+{
+    ///log10(2) < 0.30103
+    return std::size_t(this->digitCount()) * 30103 / 100000 + 1;
+}
+
+char* uInt::toChars(char *first, char *last) const
+{
+    bool fits = true;
+    auto sink = [&](const char *digits, size_type count) {
+        if (fits && last - first >= count)
+          first = std::copy_n(digits, count, first);
+        else fits = false;
+    };
+    writeDecimal(uInt(*this), sink);
+    return fits ? first : nullptr;
+}
+
+template<typename Sink>
+void uInt::writeDecimal(uInt &&x, Sink &sink)
+{
+    if (!x) return sink("0", 1);
+    int level = 0;
+    if (x.size() >= k_ioRecursiveThreshold)
+      while (2 * (ioPower(level).size() - 1) < x.size()) ++level;
+    writeDecimal(std::move(x), level, 0, sink);
+}
+
+///x must be less than ioPower(level + 1), small parts are split into 
+///blocks by single limb divisions
+template<typename Sink>
+void uInt::writeDecimal(uInt &&x, int level, size_type width, Sink &sink)
+{
+    if (x.size() < k_ioRecursiveThreshold) {
+      ///the blocks of k_ioDecDigit digits, least significant first
+      base_type blocks[2 * k_ioRecursiveThreshold];
+      size_type count = 0;
+      while (x) {
+        wcalc_type block;
+        x.size = unsafeSmallDivMod(x, k_ioUnit, x.data(), &block);
+        blocks[count++] = block;
+      }
+      char digits[k_ioDecDigit];
+      int top = k_ioDecDigit;
+      if (count != 0)
+        for (calc_type block = blocks[count - 1]; block; block /= ten)
+          digits[--top] = '0' + block % ten;
+      const size_type length = count == 0 ? 0 : k_ioDecDigit * count - top;
+
+      if (width > length) {
+        char zeros[k_ioDecDigit];
+        std::fill_n(zeros, k_ioDecDigit, '0');
+        for (size_type pad = width - length; pad > 0; pad -= k_ioDecDigit)
+          sink(zeros, std::min(pad, size_type(k_ioDecDigit)));
+      }
+      if (count == 0) return;
+      sink(digits + top, k_ioDecDigit - top);
+      for (size_type i = count - 1; i-- > 0;) {
+        calc_type block = blocks[i];
+        for (int j = k_ioDecDigit; j-- > 0; block /= ten)
+          digits[j] = '0' + block % ten;
+        sink(digits, k_ioDecDigit);
+      }
+      return;
+    }
+    uIntDivResult parts = 
+        barrettDivMod(x, ioPower(level), ioReciprocal(level));
+    if (!parts.quo) 
+      return writeDecimal(std::move(parts.rem), level - 1, width, sink);
+    size_type low_width = size_type(k_ioDecDigit) << level;
+    writeDecimal(std::move(parts.quo), level - 1, 
+                 std::max<size_type>(width - low_width, 0), sink);
+    writeDecimal(std::move(parts.rem), level - 1, low_width, sink);
+}
+
+
+
+static constexpr char k_Digits[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+static void checkRadix(int radix)
+{
+    if (radix < 2 || radix > 36) throw std::invalid_argument("invalid radix");
+}
+///the value of c as a digit of radix, -1 if it is not one
+static int digitValue(char c, int radix)
+{
+    int res = radix;
+    if ('0' <= c && c <= '9') res = c - '0';
+    else if ('a' <= c && c <= 'z') res = c - 'a' + 10;
+    else if ('A' <= c && c <= 'Z') res = c - 'A' + 10;
+    return res < radix ? res : -1;
+}
+///log2(radix) for powers of two, 0 otherwise
+static int radixBits(int radix)
+{
+    if (radix & (radix - 1)) return 0;
+    int res = 0;
+    while (radix >>= 1) ++res;
+    return res;
+}
+///the largest power of radix below k_Base, digits receives the exponent
+static calc_type radixUnit(int radix, int &digits)
+{
+    calc_type res = radix;
+    for (digits = 1; res < k_Base / radix; ++digits) res *= radix;
+    return res;
+}
+
+uInt& uInt::parse(string_view strv, int radix) &
+{
+    checkRadix(radix);
+    const char *str = strv.data();
+    size_type len = strv.size();
+    for (size_type i = 0; i < len; ++i)
+      if (digitValue(str[i], radix) < 0)
+        throw std::invalid_argument("invalid digit");
+    if (radix == 10) return this->parse(strv);
+    while (len > 0 && *str == '0')
+    { ++str; --len; }
+
+    if (const int bits = radixBits(radix)) {
+      ///the digits are regrouped into limbs from the least significant
+      const size_type size = ceilDiv(len * bits, size_type(k_BaseBinDigit));
+      uInt res(size + 1, 0);
+      wcalc_type acc = 0;
+      int acc_bits = 0;
+      for (size_type i = len; i-- > 0;) {
+        acc |= wcalc_type(digitValue(str[i], radix)) << acc_bits;
+        acc_bits += bits;
+        if (acc_bits >= k_BaseBinDigit) {
+          res.unsafePushBack(acc & (k_Base - 1));
+          acc >>= k_BaseBinDigit;
+          acc_bits -= k_BaseBinDigit;
         }
-      else
-        while (unit) {
-          res.push_back('0' + unit % ten);
-          unit /= ten;
+      }
+      res.unsafePushBack(acc);
+      res.trimSize(res.size());
+      this->swap(res);
+      return *this;
+    }
+
+    int digits = 0;
+    const calc_type unit = radixUnit(radix, digits);
+    auto chunk = [&](const char *first, size_type count) {
+        calc_type res = 0;
+        for (size_type i = 0; i < count; ++i)
+          res = res * radix + digitValue(first[i], radix);
+        return base_type(res);
+    };
+    this->reset(ceilDiv(len, size_type(digits)) + 1);
+    if (len == 0) return *this;
+    size_type start = (len - 1) % digits + 1;
+    this->size = unsafeAdd(*this, chunk(str, start), this->data());
+    while (start < len) {
+      this->size = unsafeSmallMult(*this, unit, this->data());
+      this->size = unsafeAdd(*this, chunk(str + start, digits), this->data());
+      start += digits;
+    }
+    return *this;
+}
+
+std::string uInt::toString(int radix) const
+{
+    checkRadix(radix);
+    if (radix == 10) return this->toString();
+    if (!*this) return "0";
+    std::string res;
+    if (const int bits = radixBits(radix)) {
+      ///the limbs are regrouped into digits from the least significant
+      res.reserve(ceilDiv(this->digitCount(), size_type(bits)));
+      wcalc_type acc = 0;
+      int acc_bits = 0;
+      for (size_type i = 0; i < this->size(); ++i) {
+        acc |= wcalc_type((*this)[i]) << acc_bits;
+        acc_bits += k_BaseBinDigit;
+        for (; acc_bits >= bits; acc_bits -= bits, acc >>= bits)
+          res.push_back(k_Digits[acc & (radix - 1)]);
+      }
+      res.push_back(k_Digits[acc]);
+      while (res.back() == '0') res.pop_back();
+    }
+    else {
+      int digits = 0;
+      const calc_type unit = radixUnit(radix, digits);
+      uInt x = *this;
+      while (x) {
+        wcalc_type first;
+        x.size = unsafeSmallDivMod(x, unit, x.data(), &first);
+        calc_type rest = first;
+        for (int i = 0; i < digits && (x || rest); ++i) {
+          res.push_back(k_Digits[rest % radix]);
+          rest /= radix;
         }
+      }
     }
     std::reverse(res.begin(), res.end());
     return res;
 }
 
+static int streamRadix(const std::ios_base &stream)
+{
+    switch (stream.flags() & std::ios_base::basefield) {
+      case std::ios_base::hex: return 16;
+      case std::ios_base::oct: return 8;
+      default: return 10;
+    }
+}
+///the digits of a number read from is, from start and without the 0x of 
+///hex, throws std::invalid_argument if there are none or another sign
+static string_view streamDigits(std::istream &is, const std::string &input,
+                                std::string::size_type start)
+{
+    if (streamRadix(is) == 16 && input.size() > start + 2 
+     && input[start] == '0' && (input[start + 1] | 0x20) == 'x')
+      start += 2;
+    if (start == input.size()) throw std::invalid_argument("no digits");
+    if (input[start] == '-') throw std::invalid_argument("invalid digit");
+    return string_view(input.data() + start, input.size() - start);
+}
+
+std::istream& operator >> (std::istream &is, uInt &x)
+{
+    std::string input;
+    if (!(is >> input)) return is;
+    try {
+      if (input[0] == '-') throw std::invalid_argument("negative uInt");
+      x.parse(streamDigits(is, input, 0), streamRadix(is));
+    }
+    catch (const std::invalid_argument&) {
+      is.setstate(std::ios_base::failbit);
+    }
+    return is;
+}
+
+std::ostream& operator << (std::ostream &os, const uInt &x)
+{
+    const int radix = streamRadix(os);
+    if (radix == 10 && os.width() == 0) {
+      ///the digits go to the stream a block at a time
+      auto sink = [&os](const char *digits, size_type count) {
+          os.write(digits, count);
+      };
+      uInt::writeDecimal(uInt(x), sink);
+      return os;
+    }
+    if (radix == 10) return os << x.toString();
+    std::string res = x.toString(radix);
+    if ((os.flags() & std::ios_base::showbase) && x)
+      res.insert(0, radix == 16 ? "0x" : "0");
+    if (os.flags() & std::ios_base::uppercase)
+      for (char &c : res) c = std::toupper(static_cast<unsigned char>(c));
+    return os << res;
+}
+
+std::istream& operator >> (std::istream &is, Int &x)
+{
+    std::string input;
+    if (!(is >> input)) return is;
+    const bool negative = input[0] == '-';
+    try {
+      x.parse(streamDigits(is, input, negative), streamRadix(is));
+    }
+    catch (const std::invalid_argument&) {
+      is.setstate(std::ios_base::failbit);
+      return is;
+    }
+    if (negative) x = -x;
+    return is;
+}
+
+static constexpr std::size_t k_SerialHeaderSize = 8;
+
+static void writeLittleEndian(char *dest, std::uint64_t val, std::size_t bytes)
+{
+    for (std::size_t i = 0; i < bytes; ++i, val >>= 8)
+      dest[i] = static_cast<char>(val & 0xff);
+}
+static std::uint64_t readLittleEndian(const char *src, std::size_t bytes)
+{
+    std::uint64_t res = 0;
+    for (std::size_t i = bytes; i-- > 0;)
+      res = res << 8 | static_cast<unsigned char>(src[i]);
+    return res;
+}
+
+///the limb width and the limb count of the record at src, checked against
+///the len bytes available
+static void readSerialHeader(const char *src, std::size_t len,
+                             int &bits, std::size_t &count)
+{
+    if (len < k_SerialHeaderSize)
+      throw std::invalid_argument("truncated uInt record");
+    const std::uint64_t header = readLittleEndian(src, k_SerialHeaderSize);
+    bits = header & 0xff;
+    if (bits != 30 && bits != 62)
+      throw std::invalid_argument("malformed uInt record");
+    const std::size_t limbBytes = bits / 8 + 1;
+    if ((header >> 8) > (len - k_SerialHeaderSize) / limbBytes)
+      throw std::invalid_argument("truncated uInt record");
+    count = header >> 8;
+}
+
+std::size_t uInt::serializedSize() const noexcept
+{
+    return k_SerialHeaderSize + this->size() * sizeof(base_type);
+}
+
+std::size_t uInt::serialize(char *dest) const
+{
+    writeLittleEndian(dest, std::uint64_t(this->size()) << 8 | k_BaseBinDigit,
+                      k_SerialHeaderSize);
+    char *limbs = dest + k_SerialHeaderSize;
+    for (size_type i = 0; i < this->size(); ++i)
+      writeLittleEndian(limbs + i * sizeof(base_type), (*this)[i], 
+                        sizeof(base_type));
+    return this->serializedSize();
+}
+
+std::ostream& uInt::serialize(std::ostream &os) const
+{
+    std::string buffer(this->serializedSize(), '\0');
+    this->serialize(&buffer[0]);
+    return os.write(buffer.data(), buffer.size());
+}
+
+std::size_t uInt::deserialize(const char *src, std::size_t len) &
+{
+    int bits = 0;
+    std::size_t count = 0;
+    readSerialHeader(src, len, bits, count);
+    const std::size_t limbBytes = bits / 8 + 1;
+    const char *limbs = src + k_SerialHeaderSize;
+    const std::uint64_t bound = std::uint64_t(1) << bits;
+
+    ///records of the other limb width are repacked bit by bit
+    const size_type size = ceilDiv(count * bits, std::size_t(k_BaseBinDigit));
+    uInt res(size, size);
+    std::fill_n(res.data(), size, 0);
+    std::size_t pos = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+      std::uint64_t limb = readLittleEndian(limbs + i * limbBytes, limbBytes);
+      if (limb >= bound || (i + 1 == count && limb == 0))
+        throw std::invalid_argument("malformed uInt record");
+      for (int left = bits; left > 0;) {
+        const decompose_result at = decompose(pos);
+        const int take = std::min(left, k_BaseBinDigit - at.digit);
+        res[at.unit] |= base_type(limb & ((std::uint64_t(1) << take) - 1)) 
+                        << at.digit;
+        limb >>= take;
+        pos += take;
+        left -= take;
+      }
+    }
+    res.trimSize(size);
+    this->swap(res);
+    return k_SerialHeaderSize + count * limbBytes;
+}
+
+std::istream& uInt::deserialize(std::istream &is) &
+{
+    char header[k_SerialHeaderSize];
+    if (!is.read(header, k_SerialHeaderSize)) return is;
+    const std::uint64_t word = readLittleEndian(header, k_SerialHeaderSize);
+    const int bits = word & 0xff;
+    if (bits != 30 && bits != 62) {
+      is.setstate(std::ios_base::failbit);
+      return is;
+    }
+    const std::uint64_t count = word >> 8;
+    const std::size_t limbBytes = bits / 8 + 1;
+    if (count > (std::numeric_limits<std::size_t>::max() - k_SerialHeaderSize) 
+                / limbBytes) {
+      is.setstate(std::ios_base::failbit);
+      return is;
+    }
+    const std::size_t total = k_SerialHeaderSize + count * limbBytes;
+    ///the buffer only grows with the bytes actually read, a corrupted count
+    ///runs into the end of the stream instead of a huge allocation
+    constexpr std::size_t chunk = std::size_t(1) << 16;
+    std::string buffer(header, k_SerialHeaderSize);
+    while (buffer.size() < total) {
+      const std::size_t pos = buffer.size();
+      buffer.resize(pos + std::min(chunk, total - pos));
+      if (!is.read(&buffer[pos], buffer.size() - pos)) return is;
+    }
+    try {
+      this->deserialize(buffer.data(), buffer.size());
+    }
+    catch (const std::invalid_argument&) {
+      is.setstate(std::ios_base::failbit);
+    }
+    return is;
+}
+
+uIntView::uIntView(const char *src, std::size_t len) : m_limbs(nullptr, 0)
+{
+    int bits = 0;
+    std::size_t count = 0;
+    readSerialHeader(src, len, bits, count);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    throw std::invalid_argument("uInt records can't be viewed in place on a "
+                                "big endian host");
+#endif
+    if (bits != k_BaseBinDigit)
+      throw std::invalid_argument("uInt record of another limb width");
+    const char *limbs = src + k_SerialHeaderSize;
+    if (reinterpret_cast<std::uintptr_t>(limbs) % alignof(base_type) != 0)
+      throw std::invalid_argument("misaligned uInt record");
+    this->m_limbs = SegView(reinterpret_cast<const_pointer>(limbs), count);
+    if (count != 0 && (this->m_limbs[count - 1] == 0 
+                    || this->m_limbs[count - 1] >= k_Base))
+      throw std::invalid_argument("malformed uInt record");
+}
+
+std::size_t uIntView::serializedSize() const noexcept
+{
+    return k_SerialHeaderSize + this->m_limbs.size() * sizeof(base_type);
+}
+
+uInt uIntView::doAdd(const uIntView &l, const uIntView &r)
+{
+    return uInt::doAdd(l.m_limbs, r.m_limbs);
+}
+uInt uIntView::doSub(const uIntView &l, const uIntView &r)
+{
+    return uInt::doSub(l.m_limbs, r.m_limbs);
+}
+uInt uIntView::doMul(const uIntView &l, const uIntView &r)
+{
+    return uInt::doMul(l.m_limbs, r.m_limbs);
+}
+uInt uIntView::doDiv(const uIntView &l, const uIntView &r)
+{
+    return uInt::doDiv(l.m_limbs, uInt(r));
+}
+uInt uIntView::doMod(const uIntView &l, const uIntView &r)
+{
+    return uInt::doMod(l.m_limbs, uInt(r));
+}
+uInt uIntView::doNativeMul(const uIntView &l, std::uintmax_t r)
+{
+    return uInt::nativeMul(l.m_limbs, r);
+}
+uInt uIntView::doNativeDiv(const uIntView &l, std::uintmax_t r)
+{
+    return uInt::nativeDiv(l.m_limbs, r);
+}
+uInt uIntView::doNativeMod(const uIntView &l, std::uintmax_t r)
+{
+    return uInt::nativeMod(l.m_limbs, r);
+}
+uInt& uIntView::doAddAssign(uInt &l, const uIntView &r)
+{
+    uInt::doAddAssign(l, r.m_limbs);
+    return l;
+}
+uInt& uIntView::doSubAssign(uInt &l, const uIntView &r)
+{
+    uInt::doSubAssign(l, r.m_limbs);
+    return l;
+}
+
+///k_ioUnit^(2^level), cached for the later conversions
+const uInt& uInt::ioPower(int level)
+{
+    static thread_local std::deque<uInt> powers;
+    if (powers.empty()) powers.emplace_back(k_ioUnit);
+    while (int(powers.size()) <= level)
+      powers.push_back(doMul(powers.back(), powers.back()));
+    return powers[level];
+}
+
+const uInt& uInt::ioReciprocal(int level)
+{
+    static thread_local std::deque<uInt> reciprocals;
+    while (int(reciprocals.size()) <= level)
+      reciprocals.push_back(reciprocal(ioPower(int(reciprocals.size()))));
+    return reciprocals[level];
+}
+
+///k_Base^(2 * size) / divisor
+uInt uInt::reciprocal(const uInt &divisor)
+{
+    uInt power(divisor.size() * 2 + 1, divisor.size() * 2 + 1);
+    zeroFill(power.data(), power.size() - 1);
+    power[power.size() - 1] = 1;
+    return doDivMod(power, divisor).quo;
+}
+
+/// Barrett reduction, the divident must be less than k_Base^(2 * divisor.size())
+/// the estimated quotient is at most 2 less than the real one
+uIntDivResult uInt::barrettDivMod(SegView divident, SegView divisor, 
+                                  SegView recip)
+{
+    const size_type len = divisor.size();
+    uIntDivResult res{doMul(highPart(divident, len - 1), recip), uInt()};
+    res.quo = uInt(highPart(res.quo, len + 1));
+    res.rem = doSub(divident, doMul(res.quo, divisor));
+    while (SegView(res.rem) >= divisor) {
+      res.rem.size = unsafeSub(res.rem, divisor, res.rem.data());
+      ++res.quo;
+    }
+    return res;
+}
+
+///divide and conquer conversions: the number is split by ioPower(level) 
+///so that both halves can be converted recursively
+uInt uInt::fromDecimal(const char *str, size_type len)
+{
+    if (len <= k_ioRecursiveThreshold * k_ioDecDigit) {
+      uInt res;
+      res.parse(string_view(str, len));
+      return res;
+    }
+    int level = 0;
+    while ((size_type(k_ioDecDigit) << (level + 1)) < len) ++level;
+    size_type low_len = size_type(k_ioDecDigit) << level;
+    return doAdd(doMul(fromDecimal(str, len - low_len), ioPower(level)),
+                 fromDecimal(str + len - low_len, low_len));
+}
 
 std::uintmax_t uInt::downCast(const uInt &x) noexcept
 {
@@ -682,6 +2358,528 @@ uIntDivResult divMod(const uInt &lhs, const uInt &rhs)
 }
 
 
+struct uInt::GcdMatrix
+{
+    ///(a; b) = m * (a'; b')
+    uInt m[2][2];
+    ///the determinant is -1 instead of 1
+    bool negative;
+
+    static GcdMatrix identity()
+    {
+        return GcdMatrix{{{uInt(1), uInt()}, {uInt(), uInt(1)}}, false};
+    }
+    bool isIdentity() const
+    {
+        return !this->m[0][1] && !this->m[1][0];
+    }
+
+    ///this * [[q, 1], [1, 0]]
+    void appendQuotient(const uInt &q)
+    {
+        for (auto &row : this->m) {
+          uInt next = row[0] * q + row[1];
+          row[1] = std::move(row[0]);
+          row[0] = std::move(next);
+        }
+        this->negative = !this->negative;
+    }
+    friend GcdMatrix operator * (const GcdMatrix &lhs, const GcdMatrix &rhs)
+    {
+        GcdMatrix res;
+        for (int i = 0; i < 2; ++i)
+          for (int j = 0; j < 2; ++j)
+            res.m[i][j] = lhs.m[i][0] * rhs.m[0][j] + lhs.m[i][1] * rhs.m[1][j];
+        res.negative = lhs.negative != rhs.negative;
+        return res;
+    }
+
+    ///(res_a; res_b) = m^-1 * (a; b), fails if either would be negative
+    bool applyInverse(const uInt &a, const uInt &b, 
+                      uInt &res_a, uInt &res_b) const
+    {
+        uInt a1 = this->m[1][1] * a, a2 = this->m[0][1] * b;
+        uInt b1 = this->m[0][0] * b, b2 = this->m[1][0] * a;
+        if (this->negative) {
+          a1.swap(a2);
+          b1.swap(b2);
+        }
+        if (a1 < a2 || b1 < b2) return false;
+        res_a = std::move(a1) - a2;
+        res_b = std::move(b1) - b2;
+        return true;
+    }
+    void applyInverse(Int &a, Int &b) const
+    {
+        Int res_a = Int(this->m[1][1]) * a - Int(this->m[0][1]) * b;
+        Int res_b = Int(this->m[0][0]) * b - Int(this->m[1][0]) * a;
+        if (this->negative) {
+          res_a.negate();
+          res_b.negate();
+        }
+        a = std::move(res_a);
+        b = std::move(res_b);
+    }
+
+    ///whether b and a - b are both at least 2^s, 
+    ///the quotients of a pair reduced this way only depend on its leading bits
+    static bool reducible(const uInt &a, const uInt &b, size_type s)
+    {
+        return b.digitCount() > s && doSub(a, b).digitCount() > s;
+    }
+};
+
+/// Knuth's algorithm L on the leading 62 bits, a quotient is only accepted 
+/// when it's the same for every possible value of the lower bits
+/// if s is not 0, the steps stop before the pair drops below 2^s
+uInt::GcdMatrix uInt::lehmerMatrix(SegView a, SegView b, size_type s)
+{
+    constexpr int window = 62;
+    const size_type shift = std::max<size_type>(a.digitCount() - window, 0);
+    std::int64_t ah = a.msd(shift), bh = b.msd(shift);
+    std::int64_t limit = 0;
+    if (s != 0)
+      limit = s <= shift ? 1 
+            : s - shift < window ? std::int64_t(1) << (s - shift + 1) 
+            : std::numeric_limits<std::int64_t>::max();
+    std::int64_t A = 1, B = 0, C = 0, D = 1;
+    bool negative = false;
+    while (bh + C > 0 && bh + D > 0) {
+      std::int64_t q = (ah + A) / (bh + C);
+      if (q != (ah + B) / (bh + D)) break;
+      std::int64_t next = ah - q * bh;
+      if (next < limit || bh - next < limit) break;
+      std::int64_t tmp = A - q * C;
+      A = C;
+      C = tmp;
+      tmp = B - q * D;
+      B = D;
+      D = tmp;
+      ah = bh;
+      bh = next;
+      negative = !negative;
+    }
+    auto entry = [](std::int64_t x) {
+        return uInt(std::uintmax_t(x < 0 ? -x : x));
+    };
+    return GcdMatrix{{{entry(D), entry(B)}, {entry(C), entry(A)}}, negative};
+}
+
+/// Half-gcd: reduces a and b by Euclid quotients to about half their size,
+/// the quotients of the leading half are computed recursively
+uInt::GcdMatrix uInt::halfGcd(uInt &a, uInt &b)
+{
+    const size_type s = a.digitCount() / 2 + 1;
+    GcdMatrix res = GcdMatrix::identity();
+    if (!GcdMatrix::reducible(a, b, s)) return res;
+
+    auto reduce = [&](const GcdMatrix &step) {
+        uInt next_a, next_b;
+        if (step.isIdentity() || !step.applyInverse(a, b, next_a, next_b)
+         || !GcdMatrix::reducible(next_a, next_b, s)) 
+          return false;
+        a = std::move(next_a);
+        b = std::move(next_b);
+        res = res * step;
+        return true;
+    };
+    auto reduceLeading = [&](size_type shift) {
+        uInt high_a = a >> int(shift), high_b = b >> int(shift);
+        reduce(halfGcd(high_a, high_b));
+    };
+
+    ///a Lehmer step, or a single Euclid step if it would reduce too far
+    auto step = [&]() {
+        if (reduce(lehmerMatrix(a, b, s))) return true;
+        uIntDivResult quo_rem = doDivMod(a, b);
+        if (!GcdMatrix::reducible(b, quo_rem.rem, s)) return false;
+        res.appendQuotient(quo_rem.quo);
+        a = std::move(b);
+        b = std::move(quo_rem.rem);
+        return true;
+    };
+
+    if (b.size() >= k_HalfGcdThreshold) {
+      const size_type len = a.digitCount();
+      reduceLeading(len / 2);
+      while (a.digitCount() > len / 4 * 3)
+        if (!step()) return res;
+      ///the leading part of what's left is reduced down to about s bits
+      reduceLeading(s * 2 + 2 - a.digitCount());
+    }
+    while (step()) {}
+    return res;
+}
+
+uInt uInt::doGcd(uInt a, uInt b, Int *cofactor)
+{
+    Int cof_a = 1, cof_b = 0;
+    if (a < b) {
+      a.swap(b);
+      cof_a.swap(cof_b);
+    }
+    while (b) {
+      if (a.size() <= b.size() + 1) {
+        if (b.size() >= k_HalfGcdThreshold) {
+          GcdMatrix step = halfGcd(a, b);
+          if (!step.isIdentity()) {
+            if (cofactor) step.applyInverse(cof_a, cof_b);
+            continue;
+          }
+        }
+        else {
+          GcdMatrix step = lehmerMatrix(a, b, 0);
+          uInt next_a, next_b;
+          if (!step.isIdentity() && step.applyInverse(a, b, next_a, next_b)) {
+            a = std::move(next_a);
+            b = std::move(next_b);
+            if (cofactor) step.applyInverse(cof_a, cof_b);
+            continue;
+          }
+        }
+      }
+      uIntDivResult step = doDivMod(a, b);
+      if (cofactor) {
+        cof_a = cof_a - Int(std::move(step.quo)) * cof_b;
+        cof_a.swap(cof_b);
+      }
+      a = std::move(b);
+      b = std::move(step.rem);
+    }
+    if (cofactor) *cofactor = std::move(cof_a);
+    return a;
+}
+
+IntGcdResult extendedGcd(const Int &lhs, const Int &rhs)
+{
+    IntGcdResult res;
+    res.gcd = uInt::doGcd(lhs.m_abs, rhs.m_abs, &res.x);
+    if (rhs.sign() != Int::ZERO) 
+      res.y = (res.gcd - res.x * Int(lhs.m_abs)) / Int(rhs.m_abs);
+    if (lhs.sign() == Int::NEGATIVE) res.x.negate();
+    if (rhs.sign() == Int::NEGATIVE) res.y.negate();
+    return res;
+}
+
+
+static uInt power(uInt base, unsigned exp)
+{
+    uInt res = 1;
+    for (; exp > 0; exp >>= 1) {
+      if (exp & 1) res *= base;
+      if (exp > 1) base = base.square();
+    }
+    return res;
+}
+
+/// Newton iteration with precision doubling: the root of the leading half
+/// gives an upper bound good to about half the bits, one more step at full
+/// precision gives the root, or the root + 1 at worst
+uInt uInt::doRoot(const uInt &x, unsigned k)
+{
+    if (k == 0) throw std::domain_error("zeroth root");
+    if (k == 1 || x.digitCount() <= 1) return x;
+    const size_type len = x.digitCount();
+    ///x < 2^len <= 2^k, nothing larger than 1 can be the root
+    if (size_type(k) >= len) return 1;
+    const size_type root_len = (len - 1) / k + 1;
+
+    if (root_len <= 32) {
+      ///the leading 53 bits give the root to well within 1
+      const size_type shift = std::max<size_type>(len - 53, 0);
+      const double est = std::exp2((std::log2(double(x.msd(shift))) + shift) / k);
+      uInt res = std::uintmax_t(est);
+      while (power(res, k) > x) --res;
+      while (power(res + 1, k) <= x) ++res;
+      return res;
+    }
+
+    int k_len = 0;
+    for (unsigned tmp = k; tmp > 0; tmp >>= 1) ++k_len;
+    const size_type shift = std::max<size_type>((root_len - 1 - k_len) / 2, 1);
+    ///root(x) < (root(x >> k*shift) + 1) << shift
+    uInt res = (doRoot(x >> int(shift * k), k) + 1) << int(shift);
+    ///from above, a step never goes below the root
+    do res = (res * (k - 1) + x / power(res, k - 1)) / k;
+    while (power(res, k) > x);
+    return res;
+}
+
+bool isPerfectSquare(const uInt &x)
+{
+    if (!x) return true;
+    constexpr std::uint64_t mod64 = squareResidues(64);
+    constexpr std::uint64_t mod63 = squareResidues(63);
+    constexpr std::uint64_t mod11 = squareResidues(11);
+    constexpr std::uint64_t mod17 = squareResidues(17);
+    constexpr std::uint64_t mod19 = squareResidues(19);
+    if (!(mod64 >> (SegView(x)[0] & 63) & 1)) return false;
+    const std::uintmax_t rem = uInt::downCast(uInt::smallMod(x, 63 * 11 * 17 * 19));
+    if (!(mod63 >> rem % 63 & 1) || !(mod11 >> rem % 11 & 1)
+     || !(mod17 >> rem % 17 & 1) || !(mod19 >> rem % 19 & 1)) 
+      return false;
+    return isqrt(x).square() == x;
+}
+
+
+///the primes not greater than n, by the sieve of Eratosthenes on odd numbers
+static std::vector<std::uintmax_t> primesUpTo(std::uintmax_t n)
+{
+    std::vector<std::uintmax_t> primes;
+    if (n < 2) return primes;
+    primes.push_back(2);
+    ///composite[i] is set when 2 * i + 1 is composite
+    std::vector<bool> composite(n / 2 + 1);
+    for (std::uintmax_t i = 1; 2 * i + 1 <= n; ++i) {
+      if (composite[i]) continue;
+      const std::uintmax_t p = 2 * i + 1;
+      primes.push_back(p);
+      if (p <= n / p)
+        for (std::uintmax_t j = p * p / 2; j <= n / 2; j += p)
+          composite[j] = true;
+    }
+    return primes;
+}
+
+///gathers small factors into words, and the words into the leaves 
+///of a balanced product tree
+class FactorTree
+{
+  public:
+    void push(std::uintmax_t factor)
+    {
+        if (factor > std::numeric_limits<std::uintmax_t>::max() / this->m_word) {
+          this->m_leaves.emplace_back(this->m_word);
+          this->m_word = 1;
+        }
+        this->m_word *= factor;
+    }
+    void push(std::uintmax_t factor, unsigned count)
+    {
+        while (count--) this->push(factor);
+    }
+
+    uInt product()
+    {
+        if (this->m_word != 1) this->m_leaves.emplace_back(this->m_word);
+        this->m_word = 1;
+        return balancedProduct(this->m_leaves);
+    }
+
+  private:
+    std::vector<uInt> m_leaves;
+    std::uintmax_t m_word = 1;
+};
+
+///n! / ((n / 2)!)^2, the exponent of a prime p is the number of odd n / p^i
+static uInt primeSwing(std::uintmax_t n, 
+                       const std::vector<std::uintmax_t> &primes)
+{
+    FactorTree tree;
+    for (std::uintmax_t p : primes) {
+      if (p > n) break;
+      for (std::uintmax_t q = n / p; q > 0; q /= p)
+        if (q % 2) tree.push(p);
+    }
+    return tree.product();
+}
+
+///n! = ((n / 2)!)^2 * swing(n)
+static uInt primeSwingFactorial(std::uintmax_t n, 
+                                const std::vector<std::uintmax_t> &primes)
+{
+    if (n < 21) {
+      std::uintmax_t res = 1;
+      for (std::uintmax_t i = 2; i <= n; ++i) res *= i;
+      return res;
+    }
+    return primeSwingFactorial(n / 2, primes).square() 
+         * primeSwing(n, primes);
+}
+
+uInt factorial(std::uintmax_t n)
+{
+    return primeSwingFactorial(n, primesUpTo(n));
+}
+
+///by Legendre's formula the exponent of p is the sum over i of 
+///n / p^i - k / p^i - (n - k) / p^i; 
+///when n is much larger than k, sieving up to n is not worth it and 
+///the falling factorial n * ... * (n - k + 1) is divided by k! instead
+uInt binomial(std::uintmax_t n, std::uintmax_t k)
+{
+    if (k > n) return uInt();
+    k = std::min(k, n - k);
+    if (k == 0) return 1u;
+    if (n / 64 > k) {
+      FactorTree tree;
+      for (std::uintmax_t i = 0; i < k; ++i) tree.push(n - i);
+      return tree.product() / factorial(k);
+    }
+    FactorTree tree;
+    for (std::uintmax_t p : primesUpTo(n)) {
+      unsigned exp = 0;
+      for (std::uintmax_t qn = n / p, qk = k / p, qr = (n - k) / p; qn > 0;
+           qn /= p, qk /= p, qr /= p)
+        exp += qn - qk - qr;
+      tree.push(p, exp);
+    }
+    return tree.product();
+}
+
+uInt primorial(std::uintmax_t n)
+{
+    FactorTree tree;
+    for (std::uintmax_t p : primesUpTo(n)) tree.push(p);
+    return tree.product();
+}
+
+
+///the Jacobi symbol (a / m) for an odd m
+static int jacobi(std::uintmax_t a, std::uintmax_t m)
+{
+    int res = 1;
+    a %= m;
+    while (a != 0) {
+      for (; a % 2 == 0; a /= 2)
+        if (m % 8 == 3 || m % 8 == 5) res = -res;
+      std::swap(a, m);
+      if (a % 4 == 3 && m % 4 == 3) res = -res;
+      a %= m;
+    }
+    return m == 1 ? res : 0;
+}
+///(a / n) for an odd a and an odd n, by quadratic reciprocity
+static int jacobi(long a, const uInt &n)
+{
+    int res = 1;
+    const bool n_3mod4 = n % 4u == 3u;
+    if (a < 0) {
+      a = -a;
+      if (n_3mod4) res = -res;
+    }
+    if (a % 4 == 3 && n_3mod4) res = -res;
+    return res * jacobi(std::uintmax_t(n % std::uintmax_t(a)), std::uintmax_t(a));
+}
+
+static uInt addMod(uInt lhs, const uInt &rhs, const uInt &mod)
+{
+    lhs += rhs;
+    if (!(lhs < mod)) lhs -= mod;
+    return lhs;
+}
+static uInt subMod(uInt lhs, const uInt &rhs, const uInt &mod)
+{
+    if (lhs < rhs) lhs += mod;
+    return lhs -= rhs;
+}
+static uInt halfMod(uInt x, const uInt &mod)
+{
+    if (x.getbit(0)) x += mod;
+    return x >>= 1;
+}
+
+///x mod n for a small signed x, n > |x|
+static uInt smallResidue(long x, const uInt &n)
+{
+    return x < 0 ? n - std::uintmax_t(-x) : uInt(std::uintmax_t(x));
+}
+
+///the strong probable prime test to base a, n - 1 == d * 2^s with an odd d
+static bool millerRabin(const MontgomeryContext &ctx, std::uintmax_t a, 
+                        const uInt &d, size_type s)
+{
+    const uInt &n = ctx.modulus();
+    uInt x = ctx.powmod(a, d);
+    if (x == 1u || x == n - 1u) return true;
+    const uInt minus_one = ctx.toMontgomery(n - 1u);
+    x = ctx.toMontgomery(x);
+    for (size_type r = 1; r < s; ++r) {
+      x = ctx.sqrmod(x);
+      if (x == minus_one) return true;
+    }
+    return false;
+}
+
+///the strong Lucas probable prime test with P = 1, Q = (1 - D) / 4,
+///n + 1 == d * 2^s with an odd d of d_bits bits; 
+///the terms are kept in Montgomery form, U_k, V_k and Q^k are doubled 
+///for each bit of d and stepped to k + 1 for each set bit
+static bool strongLucas(const MontgomeryContext &ctx, long D, 
+                        const uInt &d, size_type d_bits, size_type s)
+{
+    const uInt &n = ctx.modulus();
+    const uInt dm = ctx.toMontgomery(smallResidue(D, n));
+    const uInt qm = ctx.toMontgomery(smallResidue((1 - D) / 4, n));
+    uInt u = ctx.toMontgomery(1u), v = u, qk = qm;
+    for (size_type i = d_bits - 1; i-- > 0;) {
+      u = ctx.mulmod(u, v);
+      v = subMod(ctx.sqrmod(v), addMod(qk, qk, n), n);
+      qk = ctx.sqrmod(qk);
+      if (d.getbit(i)) {
+        uInt next_u = halfMod(addMod(u, v, n), n);
+        v = halfMod(addMod(ctx.mulmod(dm, u), v, n), n);
+        u = std::move(next_u);
+        qk = ctx.mulmod(qk, qm);
+      }
+    }
+    if (!u || !v) return true;
+    for (size_type r = 1; r < s; ++r) {
+      v = subMod(ctx.sqrmod(v), addMod(qk, qk, n), n);
+      if (!v) return true;
+      qk = ctx.sqrmod(qk);
+    }
+    return false;
+}
+
+bool uInt::doIsProbablePrime(const uInt &n, unsigned rounds, bool lucas)
+{
+    static constexpr std::uintmax_t k_TrialLimit = 1000;
+    static const std::vector<std::uintmax_t> small_primes = 
+        primesUpTo(k_TrialLimit);
+    ///the primes are tested in groups, one remainder per group
+    for (size_type first = 0; first < size_type(small_primes.size());) {
+      std::uintmax_t group = 1;
+      size_type last = first;
+      while (last < size_type(small_primes.size()) 
+          && group <= std::numeric_limits<std::uintmax_t>::max() 
+                       / small_primes[last]
+          && fitsSmallDivisor(group * small_primes[last]))
+        group *= small_primes[last++];
+      const std::uintmax_t rem = std::uintmax_t(n % group);
+      for (; first < last; ++first)
+        if (rem % small_primes[first] == 0) 
+          return n == small_primes[first];
+    }
+    if (n < k_TrialLimit * k_TrialLimit) return n > 1u;
+
+    const MontgomeryContext ctx(n);
+    uInt d = n - 1u;
+    size_type s = 0;
+    while (!d.getbit(s)) ++s;
+    d >>= s;
+    for (unsigned i = 0; i < rounds && i < small_primes.size(); ++i)
+      if (!millerRabin(ctx, small_primes[i], d, s)) return false;
+    if (!lucas) return true;
+
+    ///Selfridge's choice: the first D of 5, -7, 9, -11... with (D / n) = -1,
+    ///none exists when n is a square
+    long D = 5;
+    for (int tries = 0;; ++tries) {
+      const int symbol = jacobi(D, n);
+      if (symbol == -1) break;
+      if (symbol == 0) return false;
+      if (tries == 10 && isPerfectSquare(n)) return false;
+      D = D > 0 ? -(D + 2) : -(D - 2);
+    }
+    d = n + 1u;
+    s = 0;
+    while (!d.getbit(s)) ++s;
+    d >>= s;
+    return strongLucas(ctx, D, d, d.digitCount(), s);
+}
+
+
 void uInt::incrementSafeReserve()
 {
     try{this->reserve(this->capacity() + 1);}
@@ -697,10 +2895,197 @@ void uInt::copyAndShift(uInt &dest, SegView src)
     std::copy_n(src.cdata(), src.size(), dest.data() + 1);
     dest.size = src.size() + 1;
 }
+uInt uInt::addShifted(SegView high, size_type shift, SegView low)
+{
+    uInt res(std::max(low.size(), high.size() + shift) + 1, 0);
+    res.size = res.capacity();
+    zeroFill(res.data(), res.size());
+    std::copy_n(low.cdata(), low.size(), res.data());
+    unsafeAddShifted(res.data(), high, shift);
+    res.size = n_Int::trimZero(res.data(), res.size());
+    return res;
+}
 void uInt::copy(uInt &dest, SegView src)
 {
     std::copy_n(src.cdata(), src.size(), dest.data());
     dest.size = src.size();
 }  
+void uInt::trimSize(size_type len)
+{
+    this->size = n_Int::trimZero(this->data(), len);
+}
 
-}
\ No newline at end of file
+
+
+MontgomeryContext::MontgomeryContext(uInt modulus)
+: m_modulus(std::move(modulus)), m_one(), m_rSquare(), m_inverse()
+{
+    if (!this->m_modulus.getbit(0))
+      throw std::invalid_argument("Montgomery modulus must be odd");
+    ///Newton iteration, each step doubles the number of correct bits
+    const calc_type low = this->m_modulus[0];
+    calc_type inverse = 1;
+    for (int bits = 1; bits < k_BaseBinDigit; bits *= 2)
+      inverse *= 2 - low * inverse;
+    this->m_inverse = (k_Base - (inverse & (k_Base - 1))) & (k_Base - 1);
+
+    const uInt r = uInt(1) << int(this->m_modulus.size() * k_BaseBinDigit);
+    this->m_one = r % this->m_modulus;
+    this->m_rSquare = this->m_one.square() % this->m_modulus;
+}
+
+uInt MontgomeryContext::reduce(SegView x) const
+{
+    const size_type len = this->m_modulus.size();
+    if (x.size() > len * 2) return this->reduce(uInt(x) % this->m_modulus);
+    uInt t(len * 2 + 1, 0);
+    std::copy_n(x.cdata(), x.size(), t.data());
+    zeroFill(t.data() + x.size(), len * 2 + 1 - x.size());
+    unsafeMontgomeryReduce(t.data(), this->m_modulus, this->m_inverse);
+    uInt res(SegView(t.data() + len, trimZero(t.data() + len, len + 1)));
+    if (!(res < this->m_modulus)) res -= this->m_modulus;
+    ///only when x was not below modulus * R
+    if (!(res < this->m_modulus)) res %= this->m_modulus;
+    return res;
+}
+
+uInt MontgomeryContext::toMontgomery(const uInt &x) const
+{
+    if (x < this->m_modulus) 
+      return this->mulmod(x, this->m_rSquare);
+    return this->mulmod(x % this->m_modulus, this->m_rSquare);
+}
+uInt MontgomeryContext::fromMontgomery(const uInt &x) const
+{
+    return this->reduce(x);
+}
+
+uInt MontgomeryContext::mulmod(const uInt &lhs, const uInt &rhs) const
+{
+    return this->reduce(lhs * rhs);
+}
+uInt MontgomeryContext::sqrmod(const uInt &x) const
+{
+    return this->reduce(x.square());
+}
+
+///sliding window exponentiation, 
+///the odd powers of the base up to the window size are precomputed
+uInt MontgomeryContext::powmod(const uInt &base, const uInt &exp) const
+{
+    const size_type bits = exp.digitCount();
+    int window = 1;
+    for (size_type limit : {8, 24, 80, 240, 672})
+      if (bits > limit) ++window;
+
+    std::vector<uInt> odd_powers(size_type(1) << (window - 1));
+    odd_powers[0] = this->toMontgomery(base);
+    if (window > 1) {
+      const uInt base_square = this->sqrmod(odd_powers[0]);
+      for (size_type i = 1; i < size_type(odd_powers.size()); ++i)
+        odd_powers[i] = this->mulmod(odd_powers[i - 1], base_square);
+    }
+
+    uInt res = this->m_one;
+    bool started = false;
+    for (size_type i = bits; i > 0;) {
+      if (!exp.getbit(i - 1)) {
+        res = this->sqrmod(res);
+        --i;
+        continue;
+      }
+      size_type low = std::max<size_type>(i - window, 0);
+      while (!exp.getbit(low)) ++low;
+      size_type digit = 0;
+      for (size_type j = i; j-- > low;) {
+        digit = digit * 2 + exp.getbit(j);
+        if (started) res = this->sqrmod(res);
+      }
+      if (started) res = this->mulmod(res, odd_powers[digit / 2]);
+      else res = odd_powers[digit / 2];
+      started = true;
+      i = low;
+    }
+    return this->fromMontgomery(res);
+}
+
+
+uIntDivisor::uIntDivisor(uInt divisor)
+: m_divisor(std::move(divisor)), m_reciprocal(), m_smallInverse()
+{
+    if (!this->m_divisor)
+      throw_division_by_zero_exception();
+    if (this->m_divisor.isSmallDivisor())
+      this->m_smallInverse = 
+          std::uint64_t(-1) / uInt::downCast(this->m_divisor);
+    else this->m_reciprocal = uInt::reciprocal(this->m_divisor);
+}
+
+uIntDivResult uIntDivisor::doDivMod(const uInt &value, bool want_quo) const
+{
+    SegView divident = value;
+    if (divident < this->m_divisor) 
+      return uIntDivResult{uInt(), uInt(divident)};
+    if (this->m_divisor.isSmallDivisor())
+      return this->smallDivMod(divident, want_quo);
+
+    /// Barrett reduction of blocks of divisor.size() limbs from the top,
+    /// each partial divident is less than divisor * k_Base^divisor.size()
+    const size_type block = this->m_divisor.size();
+    if (divident.size() <= block * 2)
+      return uInt::barrettDivMod(divident, this->m_divisor, 
+                                 this->m_reciprocal);
+    size_type pos = divident.size() - block;
+    uInt quo(pos + 1, pos + 1);
+    zeroFill(quo.data(), quo.size());
+    pos -= (pos - 1) % block + 1;
+    uInt rem;
+    while (true) {
+      uIntDivResult cur = uInt::barrettDivMod(
+          uInt::addShifted(rem, block, lowPart(SegView(divident, pos), 
+                                               divident.size() - pos)), 
+          this->m_divisor, this->m_reciprocal);
+      unsafeAddShifted(quo.data(), cur.quo, pos);
+      rem = std::move(cur.rem);
+      if (pos == 0) break;
+      pos -= block;
+      divident = SegView(divident, 0, pos + block);
+    }
+    quo.trimSize(quo.size());
+    return uIntDivResult{std::move(quo), std::move(rem)};
+}
+
+uIntDivResult uIntDivisor::smallDivMod(SegView divident, bool want_quo) const
+{
+    const wcalc_type divisor = uInt::downCast(this->m_divisor);
+    if (!k_SmallReciprocal) {
+      if (want_quo) {
+        uIntDivResult res{uInt(divident.size(), 0), uInt()};
+        wcalc_type rem = 0;
+        res.quo.trimSize(unsafeSmallDivMod(divident, divisor, 
+                                           res.quo.data(), &rem));
+        res.rem = uInt(std::uintmax_t(rem));
+        return res;
+      }
+      return uIntDivResult{uInt(), uInt::smallMod(divident, divisor)};
+    }
+
+    ///the estimate of each quotient limb is at most one less than the real one
+    uIntDivResult res{uInt(want_quo ? divident.size() : 0, 0), uInt()};
+    std::uint64_t rem = 0;
+    for (size_type i = divident.size(); i-- > 0;) {
+      std::uint64_t cur = (rem << k_BaseBinDigit) + divident[i];
+      std::uint64_t quo = mulHigh(cur, this->m_smallInverse);
+      rem = cur - quo * divisor;
+      if (rem >= divisor) {
+        rem -= divisor;
+        ++quo;
+      }
+      if (want_quo) res.quo[i] = quo;
+    }
+    if (want_quo) res.quo.trimSize(divident.size());
+    res.rem = uInt(std::uintmax_t(rem));
+    return res;
+}
+
+}
@@ -11,6 +11,9 @@
 #include <string> //input
 #include <limits> //unsigned long long max
 #include <memory> //unique_ptr
+#include <vector> //product trees
+#include <iterator> //iterator_traits
+#include <random> //uniform_int_distribution
 #include <cstring> //memset, memcpy
 #include <cstdint> //int types
 #include <iostream> //in-out put
@@ -34,37 +37,91 @@ inline void throw_unsigned_integer_underflow_exception()
     throw std::underflow_error("unsigned integer underflow");
 }
 
+///define ACHIBULUP__BIGNUM_WIDE_LIMB to 1 to store 62 bits per limb
+///instead of 30, the products are then computed with unsigned __int128
+#ifndef ACHIBULUP__BIGNUM_WIDE_LIMB
+#define ACHIBULUP__BIGNUM_WIDE_LIMB 0
+#endif
+
+#if ACHIBULUP__BIGNUM_WIDE_LIMB && !defined(__SIZEOF_INT128__)
+#error "ACHIBULUP__BIGNUM_WIDE_LIMB requires unsigned __int128"
+#endif
+
+///define ACHIBULUP__BIGNUM_SIMD to 0 to leave out the AVX2 limb kernels,
+///otherwise they are used when the running CPU supports them
+#ifndef ACHIBULUP__BIGNUM_SIMD
+#define ACHIBULUP__BIGNUM_SIMD 1
+#endif
+
+///define ACHIBULUP__UINT128_NATIVE to 0 to make FixedUInt use its portable
+///arithmetic even where the compiler provides unsigned __int128
+#ifndef ACHIBULUP__UINT128_NATIVE
+#ifdef __SIZEOF_INT128__
+#define ACHIBULUP__UINT128_NATIVE 1
+#else
+#define ACHIBULUP__UINT128_NATIVE 0
+#endif
+#endif
+
 using size_type = size_t;
+#if ACHIBULUP__BIGNUM_WIDE_LIMB
+using base_type = std::uint64_t;
+using calc_type = std::uint64_t;
+using wcalc_type = unsigned __int128;
+#else
 using base_type = std::uint_least32_t;
 using calc_type = std::uint_fast32_t;
 using wcalc_type = std::uint_fast64_t;
+#endif
 using const_pointer = const base_type*;
 using pointer = base_type*;
 
 
+///the limbs leave 2 bits of headroom so that carries can be accumulated
+///before being normalized
+#if ACHIBULUP__BIGNUM_WIDE_LIMB
+static constexpr int k_BaseBinDigit = 62;
+///divisors passed to the single limb kernels must fit in std::uintmax_t
+static constexpr int k_SmallDivisorBinDigit = 64;
+
+static constexpr int k_ioDecDigit = 18;
+static constexpr base_type k_ioUnit = 1000000000000000000u;
+#else
 static constexpr int k_BaseBinDigit = 30;
-static constexpr base_type k_Base = 1u << k_BaseBinDigit;
-static constexpr wcalc_type 
-k_SmallDivisorLimit = std::numeric_limits<wcalc_type>::max() / k_Base;
+static constexpr int k_SmallDivisorBinDigit = 64 - k_BaseBinDigit;
 
 static constexpr int k_ioDecDigit = 9;
 static constexpr base_type k_ioUnit = 1000000000;
+#endif
+static constexpr base_type k_Base = base_type(1) << k_BaseBinDigit;
 
 template<typename Tp>
 using isIntegral_t = EnableIf_t<std::is_integral<Tp>::value>*;
 
+///owns the limb buffer, values of up to k_LocalSize limbs are stored inline
+///and only larger capacities are allocated on the heap
 class IntData
 {
   public:
     using const_pointer = n_Int::const_pointer;
     using pointer = n_Int::pointer;
 
-    IntData() noexcept : m_data(), size() {}
-    explicit IntData(size_type cap) 
-    : m_data(newArray(cap)), size(cap) {}
+    static constexpr size_type k_LocalSize = 
+        (128 + k_BaseBinDigit - 1) / k_BaseBinDigit;
+
+    IntData() noexcept : m_heap(), m_local(), size(k_LocalSize) {}
+    explicit IntData(size_type cap) : IntData()
+    {
+        if (cap > k_LocalSize) {
+          this->m_heap.reset(new base_type[cap]);
+          this->size = cap;
+        }
+    }
 
-    IntData(IntData &&mov) noexcept
-    : m_data(Move(mov.m_data)), size(Move(mov.size)) {}
+    IntData(IntData &&mov) noexcept : IntData()
+    {
+        this->steal(mov);
+    }
     IntData& operator = (IntData &&mov) & noexcept
     {
         swap(*this, mov);
@@ -79,17 +136,17 @@ class IntData
 
     base_type& operator[] (size_type i)
     {
-        return this->m_data[i];
+        return this->data()[i];
     }
     base_type operator[] (size_type i) const
     {
-        return this->m_data[i];
+        return this->cdata()[i];
     }
 
 
     const_pointer cdata() const
     {
-        return this->m_data.get();
+        return this->m_heap ? this->m_heap.get() : this->m_local;
     }
     const_pointer data() const
     {
@@ -97,7 +154,7 @@ class IntData
     }
     pointer data()
     {
-        return this->m_data.get();
+        return this->m_heap ? this->m_heap.get() : this->m_local;
     }
 
 
@@ -116,19 +173,37 @@ class IntData
   private:
     static void doSwap(IntData &a, IntData &b) noexcept
     {
-        using std::swap;
-        swap(a.m_data, b.m_data);
-        a.size.swap(b.size);
+        if (a.m_heap && b.m_heap) {
+          using std::swap;
+          swap(a.m_heap, b.m_heap);
+          a.size.swap(b.size);
+        }
+        else {
+          IntData tmp(Move(a));
+          a.steal(b);
+          b.steal(tmp);
+        }
     }
 
-
-    static pointer newArray(size_type len)
-    { 
-        return len ? new base_type[len] : pointer();
+    ///takes over the buffer of src and leaves it empty,
+    ///the old heap buffer of this is released
+    void steal(IntData &src) noexcept
+    {
+        if (src.m_heap) {
+          this->m_heap = Move(src.m_heap);
+          this->size = src.size();
+          src.size = k_LocalSize;
+        }
+        else {
+          this->m_heap.reset();
+          this->size = k_LocalSize;
+          std::copy_n(src.m_local, k_LocalSize, this->m_local);
+        }
     }
 
 
-    std::unique_ptr<base_type[]> m_data;
+    std::unique_ptr<base_type[]> m_heap;
+    base_type m_local[k_LocalSize];
 
   public:
     ReadOnlyProperty<size_type, IntData> size;
@@ -145,7 +220,7 @@ class SegView
     SegView() = delete;
     SegView(const SegView&) = default;
   
-    SegView(const_pointer start, size_type len) noexcept
+    constexpr SegView(const_pointer start, size_type len) noexcept
     : data(start), size(len) {}
 
     SegView(const base_type &b) noexcept : data(&b), size(!!b) {}
@@ -156,12 +231,12 @@ class SegView
     : data(s.cdata() + start), size(len) {}
     
 
-    base_type operator[] (size_type i) const
+    constexpr base_type operator[] (size_type i) const
     {
         return this->cdata()[i];
     }
 
-    const_pointer cdata() const
+    constexpr const_pointer cdata() const
     {
         return this->data();
     }
@@ -169,18 +244,21 @@ class SegView
     ReadOnlyProperty<size_type, SegView> size;
 
 
-    friend bool operator == (SegView lhs, SegView rhs)
+    friend ACHIBULUP__constexpr_fun14 
+    bool operator == (SegView lhs, SegView rhs)
     {
         if (lhs.size() != rhs.size()) return false;
         for(size_type i = lhs.size(); i-- > 0;)
           if (lhs[i] != rhs[i]) return false;
         return true;
     }
-    friend bool operator != (SegView lhs, SegView rhs)
+    friend ACHIBULUP__constexpr_fun14 
+    bool operator != (SegView lhs, SegView rhs)
     {
         return !(lhs == rhs);
     }
-    friend bool operator < (SegView lhs, SegView rhs)
+    friend ACHIBULUP__constexpr_fun14 
+    bool operator < (SegView lhs, SegView rhs)
     {
         if (lhs.size() != rhs.size()) 
           return lhs.size() < rhs.size();
@@ -189,15 +267,18 @@ class SegView
             return lhs[i] < rhs[i];
         return false;
     }
-    friend bool operator > (SegView lhs, SegView rhs)
+    friend ACHIBULUP__constexpr_fun14 
+    bool operator > (SegView lhs, SegView rhs)
     {
         return rhs < lhs;
     }
-    friend bool operator <= (SegView lhs, SegView rhs)
+    friend ACHIBULUP__constexpr_fun14 
+    bool operator <= (SegView lhs, SegView rhs)
     {
         return !(rhs < lhs);
     }
-    friend bool operator >= (SegView lhs, SegView rhs)
+    friend ACHIBULUP__constexpr_fun14 
+    bool operator >= (SegView lhs, SegView rhs)
     {
         return !(lhs < rhs);
     }
@@ -210,9 +291,44 @@ class SegView
 
 }; //SegView
 
+///the limbs of a native integer, viewed without allocating
+class NativeLimbs
+{
+  public:
+    explicit NativeLimbs(std::uintmax_t val) noexcept : m_size(0)
+    {
+        for (; val != 0; val >>= k_BaseBinDigit)
+          this->m_limbs[this->m_size++] = val & (k_Base - 1);
+    }
+
+    operator SegView () const noexcept
+    {
+        return SegView(this->m_limbs, this->m_size);
+    }
+
+  private:
+    static constexpr size_type k_MaxSize = 
+        (std::numeric_limits<std::uintmax_t>::digits + k_BaseBinDigit - 1) 
+        / k_BaseBinDigit;
+
+    base_type m_limbs[k_MaxSize];
+    size_type m_size;
+};
+
+///lets the expression templates of BignumExpr.hpp size the destination
+struct ExprAccess;
+
 } //namespace n_Int
 
+///the number of threads that the multiplication of very large numbers 
+///may use, the calling thread included; 1, the default, keeps it serial
+void setMultiplicationThreads(unsigned count);
+unsigned multiplicationThreads() noexcept;
+
 struct uIntDivResult;
+class Int;
+class uIntView;
+struct IntGcdResult;
 
 ///big unsigned integer
 class uInt
@@ -224,7 +340,7 @@ class uInt
     uInt(const uInt &cpy) : uInt(cpy.size(), 0) { *this = cpy; }
 
     uInt(uInt &&mov) noexcept 
-    : m_data(Move(mov.m_data)), size(Move(mov.size)) {}
+    : m_data(Move(mov.m_data)), size(mov.size()) { mov.size = 0; }
 
     uInt& operator = (const uInt &cpy) &;
     uInt& operator = (uInt &&mov) & noexcept;
@@ -271,6 +387,45 @@ class uInt
     { return !(r < l); }
     friend bool operator >= (const uInt &l, const uInt &r)
     { return !(l < r); }
+
+    ///native operands are viewed through NativeLimbs instead of being
+    ///converted to a uInt, small ones go straight to the single limb kernels
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend bool operator == (const uInt &l, intg r)
+    { return doEqual(l, n_Int::NativeLimbs(r)); }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend bool operator != (const uInt &l, intg r)
+    { return !(l == r); }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend bool operator < (const uInt &l, intg r)
+    { return doLess(l, n_Int::NativeLimbs(r)); }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend bool operator > (const uInt &l, intg r)
+    { return doLess(n_Int::NativeLimbs(r), l); }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend bool operator <= (const uInt &l, intg r)
+    { return !(l > r); }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend bool operator >= (const uInt &l, intg r)
+    { return !(l < r); }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend bool operator == (intg l, const uInt &r)
+    { return r == l; }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend bool operator != (intg l, const uInt &r)
+    { return r != l; }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend bool operator < (intg l, const uInt &r)
+    { return r > l; }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend bool operator > (intg l, const uInt &r)
+    { return r < l; }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend bool operator <= (intg l, const uInt &r)
+    { return r >= l; }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend bool operator >= (intg l, const uInt &r)
+    { return r <= l; }
     
     uInt& operator ++() &;
     uInt operator ++ (int) &
@@ -327,6 +482,20 @@ class uInt
     {
         return doMul(rhs, lhs);
     }
+
+    ///same as *this * *this, but cheaper
+    uInt square() const
+    {
+        return doSqr(*this);
+    }
+
+    ///dest += lhs * rhs, small products are accumulated straight into dest
+    friend void addmul(uInt &dest, const uInt &lhs, const uInt &rhs)
+    {
+        doAddMul(dest, lhs, rhs, false);
+    }
+    ///dest -= lhs * rhs, dest is left unchanged if it would underflow
+    friend void submul(uInt &dest, const uInt &lhs, const uInt &rhs);
     
     ///have to be defined outside because of incomplete type issue
     friend uInt operator / (const uInt& lhs, const uInt &rhs)
@@ -339,6 +508,100 @@ class uInt
     }
     friend uIntDivResult divMod(const uInt&, const uInt&);
 
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend uInt operator + (const uInt &lhs, intg rhs)
+    {
+        return doAdd(lhs, n_Int::NativeLimbs(rhs));
+    }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend uInt operator + (uInt &&lhs, intg rhs)
+    {
+        return doAdd(n_Int::NativeLimbs(rhs), std::move(lhs));
+    }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend uInt operator + (intg lhs, const uInt &rhs)
+    {
+        return rhs + lhs;
+    }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend uInt operator + (intg lhs, uInt &&rhs)
+    {
+        return std::move(rhs) + lhs;
+    }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend uInt operator - (const uInt &lhs, intg rhs)
+    {
+        return doSub(lhs, n_Int::NativeLimbs(rhs));
+    }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend uInt operator - (uInt &&lhs, intg rhs)
+    {
+        return doSub(std::move(lhs), n_Int::NativeLimbs(rhs));
+    }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend uInt operator - (intg lhs, const uInt &rhs)
+    {
+        return doSub(n_Int::NativeLimbs(lhs), rhs);
+    }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend uInt operator * (const uInt &lhs, intg rhs)
+    {
+        return nativeMul(lhs, rhs);
+    }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend uInt operator * (intg lhs, const uInt &rhs)
+    {
+        return nativeMul(rhs, lhs);
+    }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend uInt operator / (const uInt &lhs, intg rhs)
+    {
+        return nativeDiv(lhs, rhs);
+    }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend uInt operator % (const uInt &lhs, intg rhs)
+    {
+        return nativeMod(lhs, rhs);
+    }
+
+    friend uInt gcd(const uInt &lhs, const uInt &rhs)
+    {
+        return doGcd(lhs, rhs, nullptr);
+    }
+    friend uInt lcm(const uInt &lhs, const uInt &rhs)
+    {
+        if (!lhs || !rhs) return uInt();
+        return lhs / gcd(lhs, rhs) * rhs;
+    }
+    friend IntGcdResult extendedGcd(const Int&, const Int&);
+
+    ///floor of the square root
+    friend uInt isqrt(const uInt &x)
+    {
+        return doRoot(x, 2);
+    }
+    ///floor of the k-th root
+    friend uInt iroot(const uInt &x, unsigned k)
+    {
+        return doRoot(x, k);
+    }
+    friend bool isPerfectSquare(const uInt &x);
+
+    ///trial division by the small primes, then Miller-Rabin tests to the 
+    ///first \a rounds prime bases and, if \a lucas, a strong Lucas test; 
+    ///the test to base 2 and the Lucas test make up the Baillie-PSW test
+    friend bool isProbablePrime(const uInt &n, unsigned rounds = 1, 
+                                bool lucas = true)
+    {
+        return doIsProbablePrime(n, rounds, lucas);
+    }
+
+    ///the limbs are filled straight from the engine
+    template<typename Engine>
+    friend uInt randomBits(n_Int::size_type bits, Engine &engine);
+    template<typename Engine>
+    friend uInt randomBelow(const uInt &bound, Engine &engine);
+
 
  
     bool getbit(size_t pos) const noexcept;
@@ -409,16 +672,31 @@ class uInt
     }
 
 
+    ///the compound assignments work in the existing buffer 
+    ///and only reallocate when the result can't fit
     uInt& operator += (const uInt &rhs) &
-    { 
-        if(&rhs == this) return *this += std::move(*this);
-        return *this = std::move(*this) + rhs; 
-    }
+    { doAddAssign(*this, rhs); return *this; }
     uInt& operator += (uInt &&rhs) &
-    { return *this = std::move(*this) + std::move(rhs); }
+    { doAddAssign(*this, std::move(rhs)); return *this; }
 
     uInt& operator -= (const uInt &rhs) &
-    { return *this = std::move(*this) - rhs; }
+    { doSubAssign(*this, rhs); return *this; }
+
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    uInt& operator += (intg rhs) &
+    { doAddAssign(*this, n_Int::NativeLimbs(rhs)); return *this; }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    uInt& operator -= (intg rhs) &
+    { doSubAssign(*this, n_Int::NativeLimbs(rhs)); return *this; }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    uInt& operator *= (intg rhs) &
+    { nativeMulAssign(*this, rhs); return *this; }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    uInt& operator /= (intg rhs) &
+    { nativeDivAssign(*this, rhs); return *this; }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    uInt& operator %= (intg rhs) &
+    { return *this = nativeMod(*this, rhs); }
 
     uInt& operator *= (const uInt &rhs) &
     { return *this = *this * rhs; }
@@ -428,21 +706,19 @@ class uInt
     { return *this = *this % rhs; }
 
     uInt& operator &= (const uInt &rhs) &
-    { return *this = std::move(*this) & rhs; }
-    uInt& operator &= (uInt &&rhs) &
-    { return *this = std::move(*this) & std::move(rhs); }
+    { doAndAssign(*this, rhs); return *this; }
     uInt& operator |= (const uInt &rhs) &
-    { return *this = std::move(*this) | rhs; }
+    { doOrAssign(*this, rhs); return *this; }
     uInt& operator |= (uInt &&rhs) &
-    { return *this = std::move(*this) | std::move(rhs); }
+    { doOrAssign(*this, std::move(rhs)); return *this; }
     uInt& operator ^= (const uInt &rhs) &
-    { return *this = std::move(*this) ^ rhs; }
+    { doXorAssign(*this, rhs); return *this; }
     uInt& operator ^= (uInt &&rhs) &
-    { return *this = std::move(*this) ^ std::move(rhs); }
+    { doXorAssign(*this, std::move(rhs)); return *this; }
     uInt& operator >>= (int rhs) &
-    { return *this = std::move(*this) >> rhs; }
+    { doShrAssign(*this, rhs); return *this; }
     uInt& operator <<= (int rhs) &
-    { return *this = std::move(*this) << rhs; }
+    { doShlAssign(*this, rhs); return *this; }
 
 
 
@@ -451,12 +727,28 @@ class uInt
     {
         return std::move(this->parse(strv));
     }
+    ///digits of a radix from 2 to 36, letters in either case; throws 
+    ///std::invalid_argument on other characters, power of two radices are 
+    ///read in linear time by regrouping the bits into limbs
+    uInt& parse(string_view strv, int radix) &;
+    uInt&& parse(string_view strv, int radix) &&
+    {
+        return std::move(this->parse(strv, radix));
+    }
 
     std::string toString() const &
     {
         return uInt(*this).toString();
     }
     std::string toString() &&;
+    ///at least the number of decimal digits, from the bit count
+    std::size_t toCharsBound() const noexcept;
+    ///writes the decimal digits to [first, last), without a terminator, and
+    ///returns their end; nullptr if the range is too small, its content is
+    ///then unspecified, toCharsBound() characters are always enough
+    char* toChars(char *first, char *last) const;
+    ///lowercase digits of a radix from 2 to 36, linear for powers of two
+    std::string toString(int radix) const;
 
     friend std::string to_string(uInt x)
     {
@@ -464,20 +756,32 @@ class uInt
     }
 
     
-    friend std::istream& operator >> (std::istream &is, uInt &x) 
-    {
-        std::string input;
-        is >> input;
-        x.parse(input);
-        return is;
-    }
-
-    friend std::ostream& operator << (std::ostream &os, const uInt &x)
-    {
-        return os << to_string(x);
-    }
+    ///std::hex and std::oct select the radix, on input a 0x prefix is 
+    ///accepted in hex and invalid digits set failbit; on output std::showbase 
+    ///and std::uppercase apply
+    friend std::istream& operator >> (std::istream &is, uInt &x);
+    friend std::ostream& operator << (std::ostream &os, const uInt &x);
+
+    ///binary format: a little endian 64 bit header with the bits per limb
+    ///in its low byte and the limb count above, then the limbs as little
+    ///endian words of sizeof(base_type) bytes; linear both ways
+    std::size_t serializedSize() const noexcept;
+    ///writes serializedSize() bytes to dest and returns that count
+    std::size_t serialize(char *dest) const;
+    std::ostream& serialize(std::ostream &os) const;
+    ///reads a record written with either limb width and returns the bytes
+    ///it took, throws std::invalid_argument if it is truncated or malformed
+    std::size_t deserialize(const char *src, std::size_t len) &;
+    ///sets failbit if the record is truncated or malformed
+    std::istream& deserialize(std::istream &is) &;
 
   private:
+    friend class Int;
+    friend class uIntView;
+    friend struct n_Int::ExprAccess;
+    friend class MontgomeryContext;
+    friend class uIntDivisor;
+
     using size_type = n_Int::size_type;
     using base_type = n_Int::base_type;
     using calc_type = n_Int::calc_type;
@@ -487,7 +791,7 @@ class uInt
 
     // static constexpr int k_BaseBinDigit = n_Int::k_BaseBinDigit;
     // static constexpr base_type k_Base = n_Int::k_Base;
-    // static constexpr wcalc_type k_SmallDivisorLimit = n_Int::k_SmallDivisorLimit;
+    // static constexpr int k_SmallDivisorBinDigit = n_Int::k_SmallDivisorBinDigit;
 
     // static constexpr int k_ioDecDigit = n_Int::k_ioDecDigit;
     // static constexpr base_type k_ioUnit = n_Int::k_ioUnit;
@@ -520,9 +824,18 @@ class uInt
     static uInt doSub(uInt &&l, n_Int::SegView r);
     static uInt doSub(uInt &&l, uInt &&r);
     static uInt doMul(n_Int::SegView l, n_Int::SegView r);
+    static uInt doSqr(n_Int::SegView x);
+    ///dest = |dest +/- l * r|, returns whether dest +/- l * r is negative
+    static bool doAddMul(uInt &dest, n_Int::SegView l, n_Int::SegView r, 
+                         bool subtract);
     static uInt doDiv(n_Int::SegView l, const uInt &r);
     static uInt doMod(n_Int::SegView l, const uInt &r);
     static uIntDivResult doDivMod(n_Int::SegView l, const uInt &r);
+    static uIntDivResult schoolbookDivMod(n_Int::SegView l, const uInt &r);
+    static uIntDivResult recursiveDivMod(n_Int::SegView l, n_Int::SegView r);
+    static uInt reciprocal(const uInt &divisor);
+    static uIntDivResult barrettDivMod(n_Int::SegView l, n_Int::SegView r, 
+                                       n_Int::SegView recip);
     bool doGetBit(size_t pos) const noexcept;
     static uInt doAnd(const uInt &l, const uInt &r);
     static uInt doAnd(const uInt &l, uInt &&r);
@@ -538,14 +851,63 @@ class uInt
     static uInt doShr(const uInt &l, int r);
     static uInt doShr(uInt &&l, int r);
 
+    ///the rvalue overloads take over r's buffer if l's is too small
+    static void doAddAssign(uInt &l, n_Int::SegView r);
+    static void doAddAssign(uInt &l, uInt &&r);
+    static void doSubAssign(uInt &l, n_Int::SegView r);
+    ///l = r - l
+    static void doReverseSubAssign(uInt &l, n_Int::SegView r);
+    static void doAndAssign(uInt &l, const uInt &r);
+    static void doOrAssign(uInt &l, const uInt &r);
+    static void doOrAssign(uInt &l, uInt &&r);
+    static void doXorAssign(uInt &l, const uInt &r);
+    static void doXorAssign(uInt &l, uInt &&r);
+    static void doShlAssign(uInt &l, int r);
+    static void doShrAssign(uInt &l, int r);
+
+    static uInt nativeMul(n_Int::SegView l, std::uintmax_t r);
+    static uInt nativeDiv(n_Int::SegView l, std::uintmax_t r);
+    static uInt nativeMod(n_Int::SegView l, std::uintmax_t r);
+    static void nativeMulAssign(uInt &l, std::uintmax_t r);
+    static void nativeDivAssign(uInt &l, std::uintmax_t r);
+
     static uInt smallOrderedProduct(n_Int::SegView l, n_Int::SegView r);
     static uInt bigOrderedProduct(n_Int::SegView l, n_Int::SegView r);
+    static void unsafeKaratsubaMul(n_Int::SegView l, n_Int::SegView r,
+                                   pointer res, pointer scratch);
+    static uInt smallSquare(n_Int::SegView x);
+    static uInt bigSquare(n_Int::SegView x);
+    static uInt toomCookProduct(n_Int::SegView l, n_Int::SegView r, int parts);
+    static uInt nttProduct(n_Int::SegView l, n_Int::SegView r);
     static n_Int::base_type smallDivMod(n_Int::SegView l, const uInt &r, uInt *rem);
     static uInt smallDiv(n_Int::SegView l, n_Int::wcalc_type r);
     static uInt smallMod(n_Int::SegView l, n_Int::wcalc_type r);
-    
+
+    ///signed intermediate value of the Toom-Cook interpolation
+    struct SignedTerm;
+
+    ///matrix of Euclid quotients of the Lehmer and half-gcd steps
+    struct GcdMatrix;
+    ///cofactor receives x such that gcd == a * x modulo b
+    static uInt doGcd(uInt a, uInt b, Int *cofactor);
+    static GcdMatrix lehmerMatrix(n_Int::SegView a, n_Int::SegView b, 
+                                  size_type s);
+    static GcdMatrix halfGcd(uInt &a, uInt &b);
+    static uInt doRoot(const uInt &x, unsigned k);
+    static bool doIsProbablePrime(const uInt &n, unsigned rounds, bool lucas);
+
     static std::uintmax_t downCast(const uInt &x) noexcept;
     static base_type strToBase(const char *str, size_type len);
+    static const uInt& ioPower(int level);
+    static const uInt& ioReciprocal(int level);
+    static uInt fromDecimal(const char *str, size_type len);
+    ///passes the decimal digits of x, most significant first, in blocks to
+    ///sink(const char *digits, size_type count)
+    template<typename Sink>
+    static void writeDecimal(uInt &&x, Sink &sink);
+    ///the digits are zero padded to width
+    template<typename Sink>
+    static void writeDecimal(uInt &&x, int level, size_type width, Sink &sink);
     
 
 
@@ -569,12 +931,16 @@ class uInt
 
     bool isSmallDivisor() const
     {
-        return this->size() <= 2 
-            && downCast(*this) < n_Int::k_SmallDivisorLimit;
+        return this->digitCount() <= n_Int::k_SmallDivisorBinDigit;
     }
 
     static void copyAndShift(uInt &dest, n_Int::SegView src);
+    ///high * k_Base^shift + low
+    static uInt addShifted(n_Int::SegView high, size_type shift, 
+                           n_Int::SegView low);
     static void copy(uInt &dest, n_Int::SegView src);
+    ///keeps the lowest len limbs, without leading zeros
+    void trimSize(size_type len);
 
     base_type& operator [] (size_type idx) &
     {
@@ -623,8 +989,11 @@ class uInt
     }
     void reserve(size_type cap)
     {
-        if (this->capacity() < cap)
-          *this = uInt(*this, cap);
+        ///not a move assignment, a zero would be moved without its buffer
+        if (this->capacity() < cap) {
+          uInt tmp(*this, cap);
+          this->swap(tmp);
+        }
     }
     size_type capacity() const
     {
@@ -642,153 +1011,665 @@ struct uIntDivResult
 };
 
 
-template<> inline uInt convert<uInt>(string_view str)
+///a uniformly distributed value below 2^bits
+template<typename Engine>
+uInt randomBits(n_Int::size_type bits, Engine &engine)
 {
-    uInt res;
-    res.parse(str);
+    using namespace n_Int;
+    if (bits < 0) throw std::invalid_argument("negative bit count");
+    const size_type len = (bits + k_BaseBinDigit - 1) / k_BaseBinDigit;
+    uInt res(len, 0);
+    std::uniform_int_distribution<base_type> limb(0, k_Base - 1);
+    for (size_type i = 0; i < len; ++i) res.data()[i] = limb(engine);
+    if (bits % k_BaseBinDigit != 0)
+      res.data()[len - 1] &= (base_type(1) << bits % k_BaseBinDigit) - 1;
+    res.trimSize(len);
     return res;
 }
 
-
-template<char ...cs>
-const uInt& operator "" _ulll()
+///a uniformly distributed value below bound, by rejection sampling
+template<typename Engine>
+uInt randomBelow(const uInt &bound, Engine &engine)
 {
-    static constexpr char str[]{cs..., '\0'};
-    static const uInt x = convert<uInt>(str);
-    return x;
+    if (!bound) throw std::invalid_argument("empty random range");
+    const n_Int::size_type bits = bound.digitCount();
+    uInt res;
+    do res = randomBits(bits, engine);
+    while (!(res < bound));
+    return res;
 }
 
 
+namespace n_Int
+{
+///a uInt or a uIntView on either side of the uIntView operators, 
+///at least one of them a uIntView
+template<typename L, typename R>
+using isViewOperands_t = EnableIf_t<
+    (std::is_same<L, uInt>::value || std::is_same<L, uIntView>::value)
+ && (std::is_same<R, uInt>::value || std::is_same<R, uIntView>::value)
+ && (std::is_same<L, uIntView>::value || std::is_same<R, uIntView>::value)>*;
+} //namespace n_Int
 
-struct IntDivResult;
-
-///big signed integer
-class Int
+///a read-only uInt over limbs it does not own, such as the serialized
+///records of a memory mapped file, which are then read in place by the
+///comparisons and the arithmetic; a uInt converts to a view of its own
+///limbs, which, as with string_view, must outlive the view
+class uIntView
 {
   public:
-    Int() noexcept = default;
+    uIntView(const uInt &x) noexcept : m_limbs(x) {}
+    ///views limbs that are already normalized, without leading zeros
+    explicit constexpr uIntView(n_Int::SegView limbs) noexcept 
+    : m_limbs(limbs) {}
+    ///views the record at src, which must have been serialized with this
+    ///limb width and be aligned for the limbs; throws std::invalid_argument
+    ///otherwise or if it is truncated, only the top limb is validated
+    uIntView(const char *src, std::size_t len);
+
+    ///the bytes of the record, to step to the next one
+    std::size_t serializedSize() const noexcept;
+
+    ///implicit, so that the literals and the views work wherever
+    ///a const uInt& is expected
+    operator uInt() const
+    {
+        return uInt(this->m_limbs);
+    }
+    explicit constexpr operator bool() const noexcept
+    {
+        return this->m_limbs.size() != 0;
+    }
+
+    ///the operators below take a uInt or a uIntView on either side and 
+    ///read both in place, so that mixed operands are not ambiguous;
+    ///usable in constant expressions, as are the literals
+    template<typename L, typename R, n_Int::isViewOperands_t<L, R> = nullptr>
+    friend ACHIBULUP__constexpr_fun14 
+    bool operator == (const L &l, const R &r)
+    { return uIntView(l).m_limbs == uIntView(r).m_limbs; }
+    template<typename L, typename R, n_Int::isViewOperands_t<L, R> = nullptr>
+    friend ACHIBULUP__constexpr_fun14 
+    bool operator != (const L &l, const R &r)
+    { return !(l == r); }
+    template<typename L, typename R, n_Int::isViewOperands_t<L, R> = nullptr>
+    friend ACHIBULUP__constexpr_fun14 
+    bool operator < (const L &l, const R &r)
+    { return uIntView(l).m_limbs < uIntView(r).m_limbs; }
+    template<typename L, typename R, n_Int::isViewOperands_t<L, R> = nullptr>
+    friend ACHIBULUP__constexpr_fun14 
+    bool operator > (const L &l, const R &r)
+    { return r < l; }
+    template<typename L, typename R, n_Int::isViewOperands_t<L, R> = nullptr>
+    friend ACHIBULUP__constexpr_fun14 
+    bool operator <= (const L &l, const R &r)
+    { return !(r < l); }
+    template<typename L, typename R, n_Int::isViewOperands_t<L, R> = nullptr>
+    friend ACHIBULUP__constexpr_fun14 
+    bool operator >= (const L &l, const R &r)
+    { return !(l < r); }
 
-    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
-    Int(intg val) : Int()
+    template<typename L, typename R, n_Int::isViewOperands_t<L, R> = nullptr>
+    friend uInt operator + (const L &l, const R &r)
     {
-        *this = val;
+        return doAdd(l, r);
     }
-
-    Int(uInt uns) : Int{POSITIVE, std::move(uns)} {}
-
-    Int(Int&&) noexcept = default;
-    Int(const Int&) = default;
-
-    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
-    Int& operator = (intg val) &
+    template<typename L, typename R, n_Int::isViewOperands_t<L, R> = nullptr>
+    friend uInt operator - (const L &l, const R &r)
     {
-        Sign new_sign = POSITIVE;
-        if (val < 0) {
-          new_sign = NEGATIVE;
-          val = -val;
-        }
-        if (val == 0) this->sign = ZERO;
-        else {
-          this->m_abs = val;
-          this->sign = new_sign;
-        }
-        return *this;
+        return doSub(l, r);
     }
-
-    Int& operator = (Int&&) & noexcept = default;
-    Int& operator = (const Int&) & = default;
-
-    
-
-    void swap(Int &b) noexcept
+    template<typename L, typename R, n_Int::isViewOperands_t<L, R> = nullptr>
+    friend uInt operator * (const L &l, const R &r)
     {
-        using std::swap;
-        this->sign.swap(b.sign);
-        swap(this->m_abs, b.m_abs);
+        return doMul(l, r);
     }
-    friend void swap(Int &a, Int &b) noexcept
+    ///the divisor is copied, the dividend is not
+    template<typename L, typename R, n_Int::isViewOperands_t<L, R> = nullptr>
+    friend uInt operator / (const L &l, const R &r)
     {
-        a.swap(b);
+        return doDiv(l, r);
     }
-
-
-    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
-    explicit operator intg() const noexcept
+    template<typename L, typename R, n_Int::isViewOperands_t<L, R> = nullptr>
+    friend uInt operator % (const L &l, const R &r)
     {
-        return static_cast<intg>(this->m_abs) * this->sign();
+        return doMod(l, r);
     }
-
-    explicit operator bool() const noexcept
+    ///the bitwise operators copy both operands
+    template<typename L, typename R, n_Int::isViewOperands_t<L, R> = nullptr>
+    friend uInt operator & (const L &l, const R &r)
     {
-        return this->sign();
+        return uInt(uIntView(l)) & uInt(uIntView(r));
     }
-
-
-    using Sign = int;
-    static constexpr Sign ZERO = 0;
-    static constexpr Sign POSITIVE = 1;
-    static constexpr Sign NEGATIVE = -POSITIVE;
-
-
-    friend bool operator == (const Int &lhs, const Int &rhs)
+    template<typename L, typename R, n_Int::isViewOperands_t<L, R> = nullptr>
+    friend uInt operator | (const L &l, const R &r)
     {
-        return lhs.sign() == rhs.sign() && lhs.m_abs == rhs.m_abs;
+        return uInt(uIntView(l)) | uInt(uIntView(r));
     }
-    friend bool operator != (const Int &lhs, const Int &rhs)
+    template<typename L, typename R, n_Int::isViewOperands_t<L, R> = nullptr>
+    friend uInt operator ^ (const L &l, const R &r)
     {
-        return !(lhs == rhs);
+        return uInt(uIntView(l)) ^ uInt(uIntView(r));
     }
-    friend bool operator < (const Int &lhs, const Int &rhs)
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend uInt operator & (const uIntView &l, intg r)
     {
-        if (&lhs == &rhs) return false;
-        if (lhs.sign() != rhs.sign()) return lhs.sign() < rhs.sign();
-        if (lhs.sign() == POSITIVE) return lhs.m_abs < rhs.m_abs;
-        if (lhs.sign() == NEGATIVE) return rhs.m_abs < lhs.m_abs;
-        return false;
+        return uInt(l) & uInt(r);
     }
-    friend bool operator > (const Int &lhs, const Int &rhs)
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend uInt operator & (intg l, const uIntView &r)
     {
-        return rhs < lhs;
+        return r & l;
     }
-    friend bool operator <= (const Int &lhs, const Int &rhs)
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend uInt operator | (const uIntView &l, intg r)
     {
-        return !(rhs < lhs);
+        return uInt(l) | uInt(r);
     }
-    friend bool operator >= (const Int &lhs, const Int &rhs)
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend uInt operator | (intg l, const uIntView &r)
     {
-        return !(lhs < rhs);
+        return r | l;
     }
-
-
-    Int& negate()
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend uInt operator ^ (const uIntView &l, intg r)
     {
-        this->sign = -this->sign();
-        return *this;
+        return uInt(l) ^ uInt(r);
     }
-
-    friend Int abs(Int x)
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend uInt operator ^ (intg l, const uIntView &r)
     {
-        if (x.sign() == NEGATIVE) x.negate();
-        return x;
+        return r ^ l;
     }
-
-    friend Int operator + (Int x)
+    friend uInt operator << (const uIntView &l, int r)
     {
-        return x;
+        return uInt(l) << r;
     }
-    friend Int operator - (Int x)
+    friend uInt operator >> (const uIntView &l, int r)
     {
-        x.negate();
-        return x;
+        return uInt(l) >> r;
     }
 
+    ///native operands are viewed through NativeLimbs, as for uInt
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend bool operator == (const uIntView &l, intg r)
+    { return l.m_limbs == n_Int::SegView(n_Int::NativeLimbs(r)); }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend bool operator != (const uIntView &l, intg r)
+    { return !(l == r); }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend bool operator < (const uIntView &l, intg r)
+    { return l.m_limbs < n_Int::SegView(n_Int::NativeLimbs(r)); }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend bool operator > (const uIntView &l, intg r)
+    { return n_Int::SegView(n_Int::NativeLimbs(r)) < l.m_limbs; }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend bool operator <= (const uIntView &l, intg r)
+    { return !(l > r); }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend bool operator >= (const uIntView &l, intg r)
+    { return !(l < r); }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend bool operator == (intg l, const uIntView &r)
+    { return r == l; }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend bool operator != (intg l, const uIntView &r)
+    { return r != l; }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend bool operator < (intg l, const uIntView &r)
+    { return r > l; }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend bool operator > (intg l, const uIntView &r)
+    { return r < l; }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend bool operator <= (intg l, const uIntView &r)
+    { return r >= l; }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend bool operator >= (intg l, const uIntView &r)
+    { return r <= l; }
 
-    Int& operator ++ () &
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend uInt operator + (const uIntView &l, intg r)
     {
-        if (this->sign() == NEGATIVE) {
-          --this->m_abs;
-          if (!this->m_abs) 
-            this->sign = ZERO;
+        return doAdd(l, uIntView(n_Int::NativeLimbs(r)));
+    }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend uInt operator + (intg l, const uIntView &r)
+    {
+        return r + l;
+    }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend uInt operator - (const uIntView &l, intg r)
+    {
+        return doSub(l, uIntView(n_Int::NativeLimbs(r)));
+    }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend uInt operator - (intg l, const uIntView &r)
+    {
+        return doSub(uIntView(n_Int::NativeLimbs(l)), r);
+    }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend uInt operator * (const uIntView &l, intg r)
+    {
+        return doNativeMul(l, r);
+    }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend uInt operator * (intg l, const uIntView &r)
+    {
+        return doNativeMul(r, l);
+    }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend uInt operator / (const uIntView &l, intg r)
+    {
+        return doNativeDiv(l, r);
+    }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend uInt operator % (const uIntView &l, intg r)
+    {
+        return doNativeMod(l, r);
+    }
+
+    friend uInt& operator += (uInt &l, const uIntView &r)
+    {
+        return doAddAssign(l, r);
+    }
+    friend uInt& operator -= (uInt &l, const uIntView &r)
+    {
+        return doSubAssign(l, r);
+    }
+
+    friend std::ostream& operator << (std::ostream &os, const uIntView &x)
+    {
+        return os << uInt(x);
+    }
+
+  private:
+    static uInt doAdd(const uIntView &l, const uIntView &r);
+    static uInt doSub(const uIntView &l, const uIntView &r);
+    static uInt doMul(const uIntView &l, const uIntView &r);
+    static uInt doDiv(const uIntView &l, const uIntView &r);
+    static uInt doMod(const uIntView &l, const uIntView &r);
+    static uInt doNativeMul(const uIntView &l, std::uintmax_t r);
+    static uInt doNativeDiv(const uIntView &l, std::uintmax_t r);
+    static uInt doNativeMod(const uIntView &l, std::uintmax_t r);
+    static uInt& doAddAssign(uInt &l, const uIntView &r);
+    static uInt& doSubAssign(uInt &l, const uIntView &r);
+
+    n_Int::SegView m_limbs;
+};
+
+
+template<> inline uInt convert<uInt>(string_view str)
+{
+    uInt res;
+    res.parse(str);
+    return res;
+}
+
+///n!, by the prime swing algorithm
+uInt factorial(std::uintmax_t n);
+///the number of ways to choose k items out of n, 0 if k > n
+uInt binomial(std::uintmax_t n, std::uintmax_t k);
+///the product of the primes not greater than n
+uInt primorial(std::uintmax_t n);
+
+
+///modular arithmetics with a fixed odd modulus in Montgomery form, 
+///a value x is represented by x * R mod modulus where R = k_Base^modulus.size()
+///no division is performed after the construction
+class MontgomeryContext
+{
+  public:
+    explicit MontgomeryContext(uInt modulus);
+
+    const uInt& modulus() const noexcept
+    {
+        return this->m_modulus;
+    }
+
+    ///converts to and from the Montgomery form, 
+    ///fromMontgomery expects x < modulus
+    uInt toMontgomery(const uInt &x) const;
+    uInt fromMontgomery(const uInt &x) const;
+
+    ///both operands and the result are in Montgomery form,
+    ///the operands are expected to be less than modulus, 
+    ///larger ones cost an extra division
+    uInt mulmod(const uInt &lhs, const uInt &rhs) const;
+    uInt sqrmod(const uInt &x) const;
+
+    ///base^exp mod modulus, the base and the result are ordinary values
+    uInt powmod(const uInt &base, const uInt &exp) const;
+
+  private:
+    using size_type = n_Int::size_type;
+    using base_type = n_Int::base_type;
+
+    ///Montgomery reduction, fast for a value less than modulus * R
+    uInt reduce(n_Int::SegView x) const;
+
+    uInt m_modulus;
+    uInt m_one;           /// R mod modulus
+    uInt m_rSquare;       /// R^2 mod modulus
+    base_type m_inverse;  /// -modulus^-1 mod k_Base
+};
+
+
+///a divisor that is reused for many dividends, 
+///its reciprocal is computed once so that each division only multiplies
+class uIntDivisor
+{
+  public:
+    explicit uIntDivisor(uInt divisor);
+
+    const uInt& divisor() const noexcept
+    {
+        return this->m_divisor;
+    }
+
+    friend uInt operator / (const uInt &lhs, const uIntDivisor &rhs)
+    {
+        return rhs.doDivMod(lhs, true).quo;
+    }
+    friend uInt operator % (const uInt &lhs, const uIntDivisor &rhs)
+    {
+        return rhs.doDivMod(lhs, false).rem;
+    }
+    friend uIntDivResult divMod(const uInt &lhs, const uIntDivisor &rhs)
+    {
+        return rhs.doDivMod(lhs, true);
+    }
+
+  private:
+    using size_type = n_Int::size_type;
+    using wcalc_type = n_Int::wcalc_type;
+
+    uIntDivResult doDivMod(const uInt &divident, bool want_quo) const;
+    uIntDivResult smallDivMod(n_Int::SegView divident, bool want_quo) const;
+
+    uInt m_divisor;
+    uInt m_reciprocal;         /// k_Base^(2 * divisor.size()) / divisor
+    wcalc_type m_smallInverse; /// (2^64 - 1) / divisor for small divisors
+};
+
+
+#if ACHIBULUP__Cpp14_later
+namespace n_Int
+{
+///the limbs of an integer literal, computed at compile time; decimal, 
+///hexadecimal and binary after a 0x or 0b prefix, or octal after a leading
+///0, as with the builtin literals, with digit separators
+template<char ...cs>
+struct LiteralLimbs
+{
+    ///no radix takes more than four bits per character
+    static constexpr size_type k_Capacity = 
+        4 * sizeof...(cs) / k_BaseBinDigit + 1;
+
+    struct Limbs
+    {
+        base_type limbs[k_Capacity];
+        size_type size;
+    };
+
+    static constexpr Limbs compute()
+    {
+        constexpr char chars[] = {cs...};
+        constexpr size_type len = sizeof...(cs);
+        Limbs res{};
+        int radix = 10;
+        size_type i = 0;
+        if (len > 2 && chars[0] == '0' && (chars[1] | 0x20) == 'x') {
+          radix = 16;
+          i = 2;
+        }
+        else if (len > 2 && chars[0] == '0' && (chars[1] | 0x20) == 'b') {
+          radix = 2;
+          i = 2;
+        }
+        else if (len > 1 && chars[0] == '0') {
+          radix = 8;
+          i = 1;
+        }
+        for (; i < len; ++i) {
+          if (chars[i] == '\'') continue;
+          wcalc_type carry = chars[i] <= '9' ? chars[i] - '0' 
+                                             : (chars[i] | 0x20) - 'a' + 10;
+          for (size_type j = 0; j < res.size; ++j) {
+            carry += wcalc_type(res.limbs[j]) * radix;
+            res.limbs[j] = carry & (k_Base - 1);
+            carry >>= k_BaseBinDigit;
+          }
+          if (carry != 0) res.limbs[res.size++] = carry;
+        }
+        return res;
+    }
+
+    static constexpr Limbs k_Value = compute();
+};
+template<char ...cs>
+constexpr typename LiteralLimbs<cs...>::Limbs LiteralLimbs<cs...>::k_Value;
+} //namespace n_Int
+
+///a view of limbs computed at compile time, so the literal costs nothing
+///at run time and can be used in constant expressions
+template<char ...cs>
+constexpr uIntView operator "" _ulll()
+{
+    using Literal = n_Int::LiteralLimbs<cs...>;
+    return uIntView(n_Int::SegView(Literal::k_Value.limbs, 
+                                   Literal::k_Value.size));
+}
+#else
+template<char ...cs>
+uIntView operator "" _ulll()
+{
+    static constexpr char str[]{cs..., '\0'};
+    static const uInt x = convert<uInt>(str);
+    return x;
+}
+#endif
+
+
+
+struct IntDivResult;
+
+///big signed integer
+class Int
+{
+  public:
+    Int() noexcept = default;
+
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    Int(intg val) : Int()
+    {
+        *this = val;
+    }
+
+    Int(uInt uns) : Int{POSITIVE, std::move(uns)} {}
+    Int(const uIntView &uns) : Int(uInt(uns)) {}
+
+    Int(Int&&) noexcept = default;
+    Int(const Int&) = default;
+
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    Int& operator = (intg val) &
+    {
+        Sign new_sign = POSITIVE;
+        if (val < 0) {
+          new_sign = NEGATIVE;
+          val = -val;
+        }
+        if (val == 0) this->sign = ZERO;
+        else {
+          this->m_abs = val;
+          this->sign = new_sign;
+        }
+        return *this;
+    }
+
+    Int& operator = (Int&&) & noexcept = default;
+    Int& operator = (const Int&) & = default;
+
+    
+
+    void swap(Int &b) noexcept
+    {
+        using std::swap;
+        this->sign.swap(b.sign);
+        swap(this->m_abs, b.m_abs);
+    }
+    friend void swap(Int &a, Int &b) noexcept
+    {
+        a.swap(b);
+    }
+
+
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    explicit operator intg() const noexcept
+    {
+        return static_cast<intg>(this->m_abs) * this->sign();
+    }
+
+    explicit operator bool() const noexcept
+    {
+        return this->sign();
+    }
+
+
+    using Sign = int;
+    static constexpr Sign ZERO = 0;
+    static constexpr Sign POSITIVE = 1;
+    static constexpr Sign NEGATIVE = -POSITIVE;
+
+
+    friend bool operator == (const Int &lhs, const Int &rhs)
+    {
+        return lhs.sign() == rhs.sign() && lhs.m_abs == rhs.m_abs;
+    }
+    friend bool operator != (const Int &lhs, const Int &rhs)
+    {
+        return !(lhs == rhs);
+    }
+    friend bool operator < (const Int &lhs, const Int &rhs)
+    {
+        if (&lhs == &rhs) return false;
+        if (lhs.sign() != rhs.sign()) return lhs.sign() < rhs.sign();
+        if (lhs.sign() == POSITIVE) return lhs.m_abs < rhs.m_abs;
+        if (lhs.sign() == NEGATIVE) return rhs.m_abs < lhs.m_abs;
+        return false;
+    }
+    friend bool operator > (const Int &lhs, const Int &rhs)
+    {
+        return rhs < lhs;
+    }
+    friend bool operator <= (const Int &lhs, const Int &rhs)
+    {
+        return !(rhs < lhs);
+    }
+    friend bool operator >= (const Int &lhs, const Int &rhs)
+    {
+        return !(lhs < rhs);
+    }
+
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend bool operator == (const Int &lhs, intg rhs)
+    {
+        return lhs.sign() == nativeSign(rhs) 
+            && lhs.m_abs == nativeAbs(rhs);
+    }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend bool operator != (const Int &lhs, intg rhs)
+    {
+        return !(lhs == rhs);
+    }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend bool operator < (const Int &lhs, intg rhs)
+    {
+        if (lhs.sign() != nativeSign(rhs)) return lhs.sign() < nativeSign(rhs);
+        if (lhs.sign() == POSITIVE) return lhs.m_abs < nativeAbs(rhs);
+        if (lhs.sign() == NEGATIVE) return nativeAbs(rhs) < lhs.m_abs;
+        return false;
+    }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend bool operator > (const Int &lhs, intg rhs)
+    {
+        if (lhs.sign() != nativeSign(rhs)) return lhs.sign() > nativeSign(rhs);
+        if (lhs.sign() == POSITIVE) return nativeAbs(rhs) < lhs.m_abs;
+        if (lhs.sign() == NEGATIVE) return lhs.m_abs < nativeAbs(rhs);
+        return false;
+    }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend bool operator <= (const Int &lhs, intg rhs)
+    {
+        return !(lhs > rhs);
+    }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend bool operator >= (const Int &lhs, intg rhs)
+    {
+        return !(lhs < rhs);
+    }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend bool operator == (intg lhs, const Int &rhs)
+    {
+        return rhs == lhs;
+    }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend bool operator != (intg lhs, const Int &rhs)
+    {
+        return rhs != lhs;
+    }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend bool operator < (intg lhs, const Int &rhs)
+    {
+        return rhs > lhs;
+    }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend bool operator > (intg lhs, const Int &rhs)
+    {
+        return rhs < lhs;
+    }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend bool operator <= (intg lhs, const Int &rhs)
+    {
+        return rhs >= lhs;
+    }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend bool operator >= (intg lhs, const Int &rhs)
+    {
+        return rhs <= lhs;
+    }
+
+
+    Int& negate()
+    {
+        this->sign = -this->sign();
+        return *this;
+    }
+
+    friend Int abs(Int x)
+    {
+        if (x.sign() == NEGATIVE) x.negate();
+        return x;
+    }
+
+    friend Int operator + (Int x)
+    {
+        return x;
+    }
+    friend Int operator - (Int x)
+    {
+        x.negate();
+        return x;
+    }
+
+
+    Int& operator ++ () &
+    {
+        if (this->sign() == NEGATIVE) {
+          --this->m_abs;
+          if (!this->m_abs) 
+            this->sign = ZERO;
         }else {
           ++this->m_abs;
           this->sign = POSITIVE;
@@ -857,45 +1738,176 @@ class Int
           return Int{lhs.sign(), std::move(lhs.m_abs) - std::move(rhs.m_abs)};
     }
 
-    friend Int operator - (const Int &lhs, const Int &rhs)
+    friend Int operator - (const Int &lhs, const Int &rhs)
+    {
+        if(lhs.sign() * -rhs.sign() != NEGATIVE)
+          return Int{(lhs.sign() ? +lhs.sign() : -rhs.sign()), 
+                      lhs.m_abs + rhs.m_abs};
+        if (lhs.m_abs < rhs.m_abs)
+          return Int{-rhs.sign(), rhs.m_abs - lhs.m_abs}; 
+        else
+          return Int{+lhs.sign(), lhs.m_abs - rhs.m_abs};
+    }
+    friend Int operator - (const Int &lhs, Int &&rhs)
+    {
+        return lhs + -std::move(rhs);
+    }
+    friend Int operator - (Int &&lhs, const Int &rhs)
+    {
+        return -(rhs + -std::move(lhs));
+    }
+    friend Int operator - (Int &&lhs, Int &&rhs)
+    {
+        return std::move(lhs) + -std::move(rhs);
+    }
+
+    friend Int operator * (const Int &lhs, const Int &rhs)
+    {
+        return Int{lhs.sign() * rhs.sign(), lhs.m_abs * rhs.m_abs};
+    }
+
+    Int square() const
+    {
+        return Int{this->sign() * this->sign(), this->m_abs.square()};
+    }
+
+    ///dest += lhs * rhs, small products are accumulated straight into dest
+    friend void addmul(Int &dest, const Int &lhs, const Int &rhs)
+    {
+        doAddMul(dest, lhs, rhs, false);
+    }
+    ///dest -= lhs * rhs
+    friend void submul(Int &dest, const Int &lhs, const Int &rhs)
+    {
+        doAddMul(dest, lhs, rhs, true);
+    }
+    friend Int operator / (const Int &lhs, const Int &rhs)
+    {
+        return Int{lhs.sign() * rhs.sign(), lhs.m_abs / rhs.m_abs};
+    }
+    friend Int operator % (const Int &lhs, const Int &rhs)
+    {
+        return Int{lhs.sign() * rhs.sign(), lhs.m_abs % rhs.m_abs};
+    }
+    friend IntDivResult divMod(const Int&, const Int&);
+
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend Int operator + (Int lhs, intg rhs)
+    {
+        return lhs += rhs;
+    }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend Int operator + (intg lhs, Int rhs)
+    {
+        return rhs += lhs;
+    }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend Int operator - (Int lhs, intg rhs)
+    {
+        return lhs -= rhs;
+    }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend Int operator - (intg lhs, Int rhs)
+    {
+        return (rhs -= lhs).negate();
+    }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend Int operator * (const Int &lhs, intg rhs)
+    {
+        return Int{lhs.sign() * nativeSign(rhs), lhs.m_abs * nativeAbs(rhs)};
+    }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend Int operator * (intg lhs, const Int &rhs)
+    {
+        return rhs * lhs;
+    }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend Int operator / (const Int &lhs, intg rhs)
+    {
+        return Int{lhs.sign() * nativeSign(rhs), lhs.m_abs / nativeAbs(rhs)};
+    }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    friend Int operator % (const Int &lhs, intg rhs)
+    {
+        return Int{lhs.sign() * nativeSign(rhs), lhs.m_abs % nativeAbs(rhs)};
+    }
+
+    friend Int gcd(const Int &lhs, const Int &rhs)
+    {
+        return gcd(lhs.m_abs, rhs.m_abs);
+    }
+    friend Int lcm(const Int &lhs, const Int &rhs)
+    {
+        return lcm(lhs.m_abs, rhs.m_abs);
+    }
+    friend IntGcdResult extendedGcd(const Int&, const Int&);
+
+    Int& operator += (const Int &rhs) &
+    { doAddAssign(*this, rhs.sign(), rhs.m_abs); return *this; }
+    Int& operator -= (const Int &rhs) &
+    { doAddAssign(*this, -rhs.sign(), rhs.m_abs); return *this; }
+    Int& operator *= (const Int &rhs) &
+    { return *this = *this * rhs; }
+    Int& operator /= (const Int &rhs) &
+    { return *this = *this / rhs; }
+    Int& operator %= (const Int &rhs) &
+    { return *this = *this % rhs; }
+
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    Int& operator += (intg rhs) &
     {
-        if(lhs.sign() * -rhs.sign() != NEGATIVE)
-          return Int{(lhs.sign() ? +lhs.sign() : -rhs.sign()), 
-                      lhs.m_abs + rhs.m_abs};
-        if (lhs.m_abs < rhs.m_abs)
-          return Int{-rhs.sign(), rhs.m_abs - lhs.m_abs}; 
-        else
-          return Int{+lhs.sign(), lhs.m_abs - rhs.m_abs};
+        doAddAssign(*this, nativeSign(rhs), n_Int::NativeLimbs(nativeAbs(rhs)));
+        return *this;
     }
-    friend Int operator - (const Int &lhs, Int &&rhs)
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    Int& operator -= (intg rhs) &
     {
-        return lhs + -std::move(rhs);
+        doAddAssign(*this, -nativeSign(rhs), n_Int::NativeLimbs(nativeAbs(rhs)));
+        return *this;
     }
-    friend Int operator - (Int &&lhs, const Int &rhs)
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    Int& operator *= (intg rhs) &
     {
-        return -(rhs + -std::move(lhs));
+        uInt::nativeMulAssign(this->m_abs, nativeAbs(rhs));
+        this->sign = this->sign() * nativeSign(rhs);
+        return *this;
     }
-    friend Int operator - (Int &&lhs, Int &&rhs)
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    Int& operator /= (intg rhs) &
     {
-        return std::move(lhs) + -std::move(rhs);
+        uInt::nativeDivAssign(this->m_abs, nativeAbs(rhs));
+        this->sign = this->sign() * nativeSign(rhs) * !!this->m_abs;
+        return *this;
     }
+    template<typename intg, n_Int::isIntegral_t<intg> = nullptr>
+    Int& operator %= (intg rhs) &
+    { return *this = *this % rhs; }
 
-    friend Int operator * (const Int &lhs, const Int &rhs)
+    friend Int isqrt(const Int &x)
     {
-        return Int{lhs.sign() * rhs.sign(), lhs.m_abs * rhs.m_abs};
+        if (x.sign() == NEGATIVE) 
+          throw std::domain_error("square root of a negative number");
+        return isqrt(x.m_abs);
     }
-    friend Int operator / (const Int &lhs, const Int &rhs)
+    ///rounds toward zero, a negative x needs an odd k
+    friend Int iroot(const Int &x, unsigned k)
     {
-        return Int{lhs.sign() * rhs.sign(), lhs.m_abs / rhs.m_abs};
+        if (x.sign() == NEGATIVE && k % 2 == 0) 
+          throw std::domain_error("even root of a negative number");
+        return Int{x.sign(), iroot(x.m_abs, k)};
     }
-    friend Int operator % (const Int &lhs, const Int &rhs)
+    friend bool isPerfectSquare(const Int &x)
     {
-        return Int{lhs.sign() * rhs.sign(), lhs.m_abs % rhs.m_abs};
+        return x.sign() != NEGATIVE && isPerfectSquare(x.m_abs);
+    }
+    friend bool isProbablePrime(const Int &n, unsigned rounds = 1, 
+                                bool lucas = true)
+    {
+        return n.sign() == POSITIVE && isProbablePrime(n.m_abs, rounds, lucas);
     }
-    friend IntDivResult divMod(const Int&, const Int&);
 
 
-    Int& parse(string_view strv) &
+    Int& parse(string_view strv, int radix = 10) &
     {
         const char *str = strv.data();
         auto len = strv.size();
@@ -905,31 +1917,41 @@ class Int
           new_sign = -new_sign;
           ++str;
         }
-        this->m_abs.parse(string_view(str, en - str));
+        this->m_abs.parse(string_view(str, en - str), radix);
         if (!this->m_abs) this->sign = ZERO;
         else this->sign = new_sign;
         return *this;
     }
-    Int&& parse(string_view strv) &&
+    Int&& parse(string_view strv, int radix = 10) &&
     {
-        return std::move(this->parse(strv));
+        return std::move(this->parse(strv, radix));
+    }
+
+    std::size_t toCharsBound() const noexcept
+    {
+        return this->m_abs.toCharsBound() + 1;
+    }
+    ///as uInt::toChars, with a leading '-' for negative numbers
+    char* toChars(char *first, char *last) const
+    {
+        if (this->sign() == NEGATIVE) {
+          if (first == last) return nullptr;
+          *first++ = '-';
+        }
+        return this->m_abs.toChars(first, last);
     }
 
     friend std::string to_string(const Int &x)
     { 
-        std::ostringstream format;
-        format << x;
-        return format.str();
+        std::string res(x.toCharsBound(), '\0');
+        char *first = &res[0];
+        res.resize(x.toChars(first, first + res.size()) - first);
+        return res;
     }
 
 
-    friend std::istream& operator >> (std::istream &is, Int &x) 
-    {
-        std::string input;
-        is >> input;
-        x.parse(input);
-        return is;
-    }
+    ///takes the radix from the stream flags, as for uInt
+    friend std::istream& operator >> (std::istream &is, Int &x);
 
     friend std::ostream& operator << (std::ostream &os, const Int &x)
     {
@@ -940,8 +1962,25 @@ class Int
 
 
   private:
+    friend struct n_Int::ExprAccess;
+
     Int(Sign si, uInt b) noexcept : sign(si * !!b), m_abs(Move(b)) {}
 
+    static void doAddMul(Int &dest, const Int &l, const Int &r, bool subtract);
+    static void doAddAssign(Int &l, Sign r_sign, n_Int::SegView r_abs);
+
+    template<typename intg>
+    static Sign nativeSign(intg x) noexcept
+    {
+        return (x > 0) - (x < 0);
+    }
+    ///|x| without overflowing on the most negative value
+    template<typename intg>
+    static std::uintmax_t nativeAbs(intg x) noexcept
+    {
+        return x < 0 ? 0 - std::uintmax_t(x) : std::uintmax_t(x);
+    }
+
 
   public:
     ReadOnlyProperty<Sign, Int> sign;
@@ -956,6 +1995,39 @@ struct IntDivResult
     Int quo, rem;
 };
 
+///gcd == lhs * x + rhs * y
+struct IntGcdResult
+{
+    Int gcd, x, y;
+};
+
+inline void Int::doAddMul(Int &dest, const Int &lhs, const Int &rhs, 
+                          bool subtract)
+{
+    const Sign prod_sign = lhs.sign() * rhs.sign() * (subtract ? -1 : 1);
+    if (prod_sign == ZERO) return;
+    const Sign dest_sign = dest.sign() == ZERO ? prod_sign : dest.sign();
+    const bool negative = uInt::doAddMul(dest.m_abs, lhs.m_abs, rhs.m_abs, 
+                                         dest_sign != prod_sign);
+    dest.sign = (negative ? -dest_sign : dest_sign) * !!dest.m_abs;
+}
+
+inline void Int::doAddAssign(Int &lhs, Sign rhs_sign, 
+                             n_Int::SegView rhs_abs)
+{
+    if (rhs_sign == ZERO) return;
+    if (lhs.sign() == ZERO || lhs.sign() == rhs_sign) {
+      uInt::doAddAssign(lhs.m_abs, rhs_abs);
+      lhs.sign = rhs_sign;
+    }
+    else if (rhs_abs < lhs.m_abs) 
+      uInt::doSubAssign(lhs.m_abs, rhs_abs);
+    else {
+      uInt::doReverseSubAssign(lhs.m_abs, rhs_abs);
+      lhs.sign = rhs_sign * !!lhs.m_abs;
+    }
+}
+
 inline IntDivResult divMod(const Int &lhs, const Int &rhs)
 {
     auto res = divMod(lhs.m_abs, rhs.m_abs);
@@ -972,11 +2044,50 @@ template<> inline Int convert<Int>(string_view str)
 }
 
 
+namespace n_Int
+{
+
+///multiplies the terms pairwise, level by level, so that the operands of 
+///each multiplication have about the same size, the terms are consumed
+template<typename Num>
+Num balancedProduct(std::vector<Num> &terms)
+{
+    if (terms.empty()) return Num(1);
+    while (terms.size() > 1) {
+      const std::size_t len = terms.size();
+      for (std::size_t i = 0; i + 1 < len; i += 2)
+        terms[i / 2] = terms[i] * terms[i + 1];
+      if (len % 2) terms[len / 2] = std::move(terms[len - 1]);
+      terms.resize((len + 1) / 2);
+    }
+    return std::move(terms[0]);
+}
+
+///signed values multiply to an Int, unsigned ones to a uInt
+template<typename Tp>
+using ProductOf_t = typename std::conditional<
+    std::is_same<Tp, Int>::value || std::is_signed<Tp>::value, 
+    Int, uInt>::type;
+
+} //namespace n_Int
+
+///the product of the values in [first, last), 1 for an empty range,
+///computed as a balanced product tree
+template<typename InputIt, typename Num = n_Int::ProductOf_t<
+             typename std::iterator_traits<InputIt>::value_type>>
+Num product(InputIt first, InputIt last)
+{
+    std::vector<Num> terms;
+    for (; first != last; ++first) terms.emplace_back(*first);
+    return n_Int::balancedProduct(terms);
+}
+
+
+///copies the limbs of the _ulll literal, without parsing
 template<char ...cs>
 const Int& operator "" _lll()
 {
-    static constexpr char str[]{cs..., '\0'};
-    static const Int x = convert<Int>(str);
+    static const Int x(uInt(operator "" _ulll<cs...>()));
     return x;
 }
 
@@ -1002,351 +2113,586 @@ const Int& operator "" _lll()
 
 
 #if ACHIBULUP__Cpp14_later
-class uint128_t
+inline constexpr int count_leading_zero(const uint64_t &x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return x ? __builtin_clzll(x) : 64;
+#else
+    int res = 0;
+    for (uint64_t bit = 1ull << 63; bit && !(x & bit); bit >>= 1)
+      ++res;
+    return res;
+#endif
+}
+
+namespace n_Int
+{
+#if ACHIBULUP__UINT128_NATIVE
+///unsigned __int128 is usable in constant expressions as well, so the
+///operators below take this path at compile time too
+using native_uint128_t = unsigned __int128;
+#endif
+
+///the full product of a and b, returns the low word and stores the high
+///word in high
+inline constexpr uint64_t mulWide(uint64_t a, uint64_t b, uint64_t &high)
+{
+#if ACHIBULUP__UINT128_NATIVE
+    const native_uint128_t res = native_uint128_t(a) * b;
+    high = static_cast<uint64_t>(res >> 64);
+    return static_cast<uint64_t>(res);
+#else
+    constexpr uint64_t mask = (1ull << 32) - 1;
+    const uint64_t a0 = a & mask, a1 = a >> 32;
+    const uint64_t b0 = b & mask, b1 = b >> 32;
+    const uint64_t p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0;
+    const uint64_t mid = (p00 >> 32) + (p01 & mask) + (p10 & mask);
+    high = a1 * b1 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+    return (mid << 32) | (p00 & mask);
+#endif
+}
+
+///divides {high, low} by d, which requires high < d, the quotient then
+///fits in 64 bits; long division on 32 bit halves of the normalized
+///divisor (Knuth's algorithm D with two quotient digits)
+inline constexpr uint64_t divide128By64(uint64_t high, uint64_t low,
+                                        uint64_t d, uint64_t &rem)
+{
+#if ACHIBULUP__UINT128_NATIVE
+    const native_uint128_t num = native_uint128_t(high) << 64 | low;
+    rem = static_cast<uint64_t>(num % d);
+    return static_cast<uint64_t>(num / d);
+#else
+    constexpr uint64_t base = 1ull << 32;
+    constexpr uint64_t mask = base - 1;
+    const int shift = count_leading_zero(d);
+    d <<= shift;
+    const uint64_t d1 = d >> 32, d0 = d & mask;
+    const uint64_t u32 = shift ? (high << shift) | (low >> (64 - shift)) : high;
+    const uint64_t u10 = low << shift;
+    const uint64_t u1 = u10 >> 32, u0 = u10 & mask;
+
+    uint64_t q1 = u32 / d1, rhat = u32 % d1;
+    while (q1 >= base || q1 * d0 > (rhat << 32 | u1)) {
+      --q1;
+      rhat += d1;
+      if (rhat >= base) break;
+    }
+    const uint64_t u21 = (u32 << 32 | u1) - q1 * d;
+
+    uint64_t q0 = u21 / d1;
+    rhat = u21 % d1;
+    while (q0 >= base || q0 * d0 > (rhat << 32 | u0)) {
+      --q0;
+      rhat += d1;
+      if (rhat >= base) break;
+    }
+    rem = ((u21 << 32 | u0) - q0 * d) >> shift;
+    return q1 << 32 | q0;
+#endif
+}
+} //namespace n_Int
+
+
+///unsigned integer of a fixed number of bits, stored in 64 bit limbs from
+///the least significant; arithmetic wraps around modulo 2^Bits
+template<std::size_t Bits>
+class FixedUInt
 {
+    static_assert(Bits >= 128 && Bits % 64 == 0,
+                  "FixedUInt is made of at least two 64 bit limbs");
   public:
-    uint128_t() noexcept = default;
+    static constexpr std::size_t k_Limbs = Bits / 64;
 
+    FixedUInt() noexcept = default;
+
+    ///negative values are sign extended, as with the builtin conversions
     template<typename Tp, typename = EnableIf_t<std::is_integral<Tp>::value>>
-    constexpr uint128_t(const Tp &val) : low((val < 0) ? -val : val), high((val < 0) ? -1 : 0) {}
-    constexpr uint128_t(uint64_t _sc, uint64_t _fi) : low(_sc), high(_fi) {}
+    constexpr FixedUInt(const Tp &val) : limbs{static_cast<uint64_t>(val)}
+    {
+        if (val < 0)
+          for (std::size_t i = 1; i < k_Limbs; ++i)
+            limbs[i] = ~0ull;
+    }
+    ///the limbs from the least significant, the rest are zero
+    template<typename ...Rest,
+             typename = EnableIf_t<sizeof...(Rest) + 2 <= Bits / 64>>
+    constexpr FixedUInt(uint64_t first, uint64_t second, Rest ...rest)
+    : limbs{first, second, static_cast<uint64_t>(rest)...} {}
+    ///truncates or zero extends
+    template<std::size_t OtherBits>
+    explicit constexpr FixedUInt(const FixedUInt<OtherBits> &other) : limbs{}
+    {
+        for (std::size_t i = 0; i < k_Limbs && i < other.k_Limbs; ++i)
+          limbs[i] = other.limbs[i];
+    }
 
     template<typename Tp, typename = EnableIf_t<std::is_integral<Tp>::value>>
     explicit constexpr operator Tp() const
     {
-        return low;
+        return static_cast<Tp>(limbs[0]);
     }
     explicit constexpr operator bool () const
     {
-        return high || low;
+        for (std::size_t i = 0; i < k_Limbs; ++i)
+          if (limbs[i]) return true;
+        return false;
     }
 
-    friend std::istream& operator >> (std::istream &is, uint128_t &x)
+    friend std::istream& operator >> (std::istream &is, FixedUInt &x)
     {
         return x.extractFrom(is);
     }
-    friend std::ostream& operator << (std::ostream &os, const uint128_t &x)
+    friend std::ostream& operator << (std::ostream &os, const FixedUInt &x)
     {
         return x.insertTo(os);
     }
 
 
-    uint64_t low, high;
-
-    static constexpr uint64_t k_MaskLow = (1ull << 32) - 1;
-  private:
-    std::istream& extractFrom(std::istream&);
-    std::ostream& insertTo(std::ostream&) const;
+    friend constexpr bool operator == (const FixedUInt &l, const FixedUInt &r)
+    {
+        for (std::size_t i = 0; i < k_Limbs; ++i)
+          if (l.limbs[i] != r.limbs[i]) return false;
+        return true;
+    }
+    friend constexpr bool operator != (const FixedUInt &l, const FixedUInt &r)
+    {   return !(l == r); }
+    friend constexpr bool operator < (const FixedUInt &l, const FixedUInt &r)
+    {
+        for (std::size_t i = k_Limbs; i--; )
+          if (l.limbs[i] != r.limbs[i]) return l.limbs[i] < r.limbs[i];
+        return false;
+    }
+    friend constexpr bool operator > (const FixedUInt &l, const FixedUInt &r)
+    {   return r < l; }
+    friend constexpr bool operator <= (const FixedUInt &l, const FixedUInt &r)
+    {   return !(r < l); }
+    friend constexpr bool operator >= (const FixedUInt &l, const FixedUInt &r)
+    {   return !(l < r); }
 
+    friend constexpr FixedUInt operator & (const FixedUInt &l, const FixedUInt &r)
+    {
+        FixedUInt res{};
+        for (std::size_t i = 0; i < k_Limbs; ++i)
+          res.limbs[i] = l.limbs[i] & r.limbs[i];
+        return res;
+    }
+    friend constexpr FixedUInt operator | (const FixedUInt &l, const FixedUInt &r)
+    {
+        FixedUInt res{};
+        for (std::size_t i = 0; i < k_Limbs; ++i)
+          res.limbs[i] = l.limbs[i] | r.limbs[i];
+        return res;
+    }
+    friend constexpr FixedUInt operator ^ (const FixedUInt &l, const FixedUInt &r)
+    {
+        FixedUInt res{};
+        for (std::size_t i = 0; i < k_Limbs; ++i)
+          res.limbs[i] = l.limbs[i] ^ r.limbs[i];
+        return res;
+    }
+    friend constexpr FixedUInt operator ~ (const FixedUInt &x)
+    {
+        FixedUInt res{};
+        for (std::size_t i = 0; i < k_Limbs; ++i)
+          res.limbs[i] = ~x.limbs[i];
+        return res;
+    }
 
+    ///the shift amount must be less than Bits
+    friend constexpr FixedUInt operator << (const FixedUInt &x, const FixedUInt &sh)
+    {
+#if ACHIBULUP__UINT128_NATIVE
+        if (k_Limbs == 2) return fromNative(toNative(x) << sh.limbs[0]);
+#endif
+        return doShl(x, sh.limbs[0]);
+    }
+    friend constexpr FixedUInt operator >> (const FixedUInt &x, const FixedUInt &sh)
+    {
+#if ACHIBULUP__UINT128_NATIVE
+        if (k_Limbs == 2) return fromNative(toNative(x) >> sh.limbs[0]);
+#endif
+        return doShr(x, sh.limbs[0]);
+    }
 
+    friend constexpr FixedUInt& operator &= (FixedUInt &x, const FixedUInt &v)
+    {   return x = x & v; }
+    friend constexpr FixedUInt& operator |= (FixedUInt &x, const FixedUInt &v)
+    {   return x = x | v; }
+    friend constexpr FixedUInt& operator ^= (FixedUInt &x, const FixedUInt &v)
+    {   return x = x ^ v; }
+    friend constexpr FixedUInt& operator <<= (FixedUInt &x, const FixedUInt &sh)
+    {   return x = x << sh; }
+    friend constexpr FixedUInt& operator >>= (FixedUInt &x, const FixedUInt &sh)
+    {   return x = x >> sh; }
 
+    friend constexpr int count_leading_zero(const FixedUInt &x)
+    {
+        for (std::size_t i = k_Limbs; i--; )
+          if (x.limbs[i])
+            return int(k_Limbs - 1 - i) * 64 + count_leading_zero(x.limbs[i]);
+        return int(Bits);
+    }
 
-};
-inline constexpr bool operator == (const uint128_t &l, const uint128_t &r)
-{
-    return l.high == r.high && l.low == r.low;
-}
-inline constexpr bool operator != (const uint128_t &l, const uint128_t &r)
-{   return !(l == r); }
-inline constexpr bool operator < (const uint128_t &l, const uint128_t &r)
-{
-    return l.high < r.high || (l.high == r.high && l.low < r.low);
-}
-inline constexpr bool operator > (const uint128_t &l, const uint128_t &r)
-{   return r < l; }
-inline constexpr bool operator <= (const uint128_t &l, const uint128_t &r)
-{   return !(r < l); }
-inline constexpr bool operator >= (const uint128_t &l, const uint128_t &r)
-{   return !(l < r); }
-
-inline constexpr uint128_t operator & (const uint128_t &l, const uint128_t &r)
-{
-    return {l.low & r.low, l.high & r.high};
-}
-inline constexpr uint128_t operator | (const uint128_t &l, const uint128_t &r)
-{
-    return {l.low | r.low, l.high | r.high};
-}
-inline constexpr uint128_t operator ^ (const uint128_t &l, const uint128_t &r)
-{
-    return {l.low ^ r.low, l.high ^ r.high};
-}
 
-inline constexpr uint128_t operator << (const uint128_t &x, const uint128_t &sh)
-{
-    return (!sh.high && sh.low < 64) ?
-    uint128_t{x.low << sh.low, (x.high << sh.low) ^ (x.low >> (64 - sh.low))}
-  : uint128_t{0, x.low << (sh.low - 64)};
-}
-inline constexpr uint128_t operator >> (const uint128_t &x, const uint128_t &sh)
-{
-    return (!sh.high && sh.low < 64) ?
-    uint128_t{(x.low >> sh.low) ^ (x.high << (64 - sh.low)), x.high >> sh.low}
-  : uint128_t{x.high >> (sh.low - 64), 0};
-}
-inline constexpr uint128_t operator ~ (const uint128_t &x)
-{
-    return uint128_t{~x.low, ~x.high};
-}
+    friend constexpr FixedUInt operator + (FixedUInt x)
+    {
+        return x;
+    }
+    friend constexpr FixedUInt operator - (const FixedUInt &x)
+    {
+        FixedUInt res = ~x;
+        return ++res;
+    }
 
-inline constexpr uint128_t& operator &= (uint128_t &x, const uint128_t &v)
-{   return x = x & v; }
-inline constexpr uint128_t& operator |= (uint128_t &x, const uint128_t &v)
-{   return x = x | v; }
-inline constexpr uint128_t& operator ^= (uint128_t &x, const uint128_t &v)
-{   return x = x ^ v; }
-inline constexpr uint128_t& operator <<= (uint128_t &x, const uint128_t &sh)
-{   return x = x << sh; }
-inline constexpr uint128_t& operator >>= (uint128_t &x, const uint128_t &sh)
-{   return x = x >> sh; }
+    friend constexpr FixedUInt& operator ++(FixedUInt &x)
+    {
+        for (std::size_t i = 0; i < k_Limbs && !++x.limbs[i]; ++i);
+        return x;
+    }
+    friend constexpr FixedUInt operator ++(FixedUInt &x, int)
+    {
+        FixedUInt res = x;
+        ++x;
+        return res;
+    }
+    friend constexpr FixedUInt& operator --(FixedUInt &x)
+    {
+        for (std::size_t i = 0; i < k_Limbs && !x.limbs[i]--; ++i);
+        return x;
+    }
+    friend constexpr FixedUInt operator --(FixedUInt &x, int)
+    {
+        FixedUInt res = x;
+        --x;
+        return res;
+    }
 
-inline constexpr int count_leading_zero(const uint64_t &x)
-{
-    return x ? (64 - int(std::log2(x)) - 1) : 64;
-}
-inline constexpr int count_leading_zero(const uint128_t &x)
-{
-    return x.high ? count_leading_zero(x.high) : (64 + count_leading_zero(x.low));
-}
+    friend constexpr FixedUInt operator + (const FixedUInt &l, const FixedUInt &r)
+    {
+#if ACHIBULUP__UINT128_NATIVE
+        if (k_Limbs == 2) return fromNative(toNative(l) + toNative(r));
+#endif
+        FixedUInt res{};
+        uint64_t carry = 0;
+        for (std::size_t i = 0; i < k_Limbs; ++i) {
+          const uint64_t sum = l.limbs[i] + carry;
+          carry = sum < carry;
+          res.limbs[i] = sum + r.limbs[i];
+          carry += res.limbs[i] < sum;
+        }
+        return res;
+    }
+    friend constexpr FixedUInt operator - (const FixedUInt &l, const FixedUInt &r)
+    {
+#if ACHIBULUP__UINT128_NATIVE
+        if (k_Limbs == 2) return fromNative(toNative(l) - toNative(r));
+#endif
+        FixedUInt res{};
+        uint64_t borrow = 0;
+        for (std::size_t i = 0; i < k_Limbs; ++i) {
+          const uint64_t diff = l.limbs[i] - borrow;
+          borrow = diff > l.limbs[i];
+          res.limbs[i] = diff - r.limbs[i];
+          borrow += res.limbs[i] > diff;
+        }
+        return res;
+    }
 
+    friend constexpr FixedUInt& operator += (FixedUInt &x, const FixedUInt &d)
+    {   return x = x + d; }
+    friend constexpr FixedUInt& operator -= (FixedUInt &x, const FixedUInt &d)
+    {   return x = x - d; }
 
-inline constexpr uint128_t operator + (uint128_t x)
-{
-    return x;
-}
-inline constexpr uint128_t operator - (const uint128_t &x)
-{
-    return {~x.low + 1, ~x.high + !x.low};
-}
 
-inline constexpr uint128_t& operator ++(uint128_t &x)
-{
-    ++x.low;
-    x.high += !x.low;
-    return x;
-}
-inline constexpr uint128_t operator ++(uint128_t &x, int)
-{
-    uint128_t res = x;
-    ++x;
-    return res;
-}
-inline constexpr uint128_t& operator --(uint128_t &x)
-{
-    --x.low;
-    x.high -= !~x.low;
-    return x;
-}
-inline constexpr uint128_t operator --(uint128_t &x, int)
-{
-    uint128_t res = x;
-    --x;
-    return res;
-}
+    friend constexpr FixedUInt operator * (const FixedUInt &l, const FixedUInt &r)
+    {
+#if ACHIBULUP__UINT128_NATIVE
+        if (k_Limbs == 2) return fromNative(toNative(l) * toNative(r));
+#endif
+        FixedUInt res{};
+        for (std::size_t i = 0; i < k_Limbs; ++i) {
+          uint64_t carry = 0;
+          for (std::size_t j = 0; i + j < k_Limbs; ++j)
+            res.limbs[i + j] = mulAddWord(l.limbs[i], r.limbs[j],
+                                          res.limbs[i + j], carry);
+        }
+        return res;
+    }
+    ///the high Bits bits of the full product of l and r
+    friend constexpr FixedUInt mulhi(const FixedUInt &l, const FixedUInt &r)
+    {
+        uint64_t full[2 * k_Limbs] = {};
+        for (std::size_t i = 0; i < k_Limbs; ++i) {
+          uint64_t carry = 0;
+          for (std::size_t j = 0; j < k_Limbs; ++j)
+            full[i + j] = mulAddWord(l.limbs[i], r.limbs[j], full[i + j], carry);
+          full[i + k_Limbs] = carry;
+        }
+        FixedUInt res{};
+        for (std::size_t i = 0; i < k_Limbs; ++i)
+          res.limbs[i] = full[i + k_Limbs];
+        return res;
+    }
+    friend constexpr FixedUInt operator / (const FixedUInt &l, const FixedUInt &r)
+    {
+        FixedUInt rem{};
+        return doDivMod(l, r, rem);
+    }
+    friend constexpr FixedUInt operator % (const FixedUInt &l, const FixedUInt &r)
+    {
+        FixedUInt rem{};
+        doDivMod(l, r, rem);
+        return rem;
+    }
 
-inline constexpr uint128_t operator + (const uint128_t &l, const uint128_t &r)
-{
-    return {l.low + r.low, l.high + r.high + (l.low > ~r.low)};
-}
-inline constexpr uint128_t operator - (const uint128_t &l, const uint128_t &r)
-{
-    return {l.low - r.low, l.high - r.high - (l.low < r.low)};
-}
+    friend constexpr FixedUInt& operator *= (FixedUInt &x, const FixedUInt &d)
+    {   return x = x * d; }
+    friend constexpr FixedUInt& operator /= (FixedUInt &x, const FixedUInt &d)
+    {   return x = x / d; }
+    friend constexpr FixedUInt& operator %= (FixedUInt &x, const FixedUInt &d)
+    {   return x = x % d; }
 
-inline constexpr uint128_t& operator += (uint128_t &x, const uint128_t &d)
-{   return x = x + d; }
-inline constexpr uint128_t& operator -= (uint128_t &x, const uint128_t &d)
-{   return x = x - d; }
 
+    uint64_t limbs[k_Limbs];
 
-inline constexpr uint128_t operator * (const uint128_t &l, const uint128_t &r)
-{
-    uint128_t res{static_cast<uint32_t>(l.low) * (r.low & uint128_t::k_MaskLow),
-      l.high * r.low + l.low * r.high + static_cast<uint32_t>(l.low >> 32) * (r.low >> 32)};
-    uint64_t v1 = static_cast<uint32_t>(l.low) * (r.low >> 32);
-    uint64_t v2 = static_cast<uint32_t>(r.low) * (l.low >> 32);
-    res.high += (v1 >> 32) + (v2 >> 32);
-    v1 = (res.low >> 32) + static_cast<uint32_t>(v1) + static_cast<uint32_t>(v2);
-    res.high += v1 >> 32;
-    res.low = (res.low & uint128_t::k_MaskLow) + ((v1 & uint128_t::k_MaskLow) << 32);
-    return res;
-}
-inline constexpr uint128_t operator / (uint128_t l, uint128_t r)
-{
-    uint128_t res{};
-    if (l < r);
-    else if (!l.high) {
-      if (!r.high) res.low = l.low / r.low;
+  private:
+#if ACHIBULUP__UINT128_NATIVE
+    static constexpr n_Int::native_uint128_t toNative(const FixedUInt &x)
+    {
+        return n_Int::native_uint128_t(x.limbs[1]) << 64 | x.limbs[0];
     }
-    else if (!r.high && r.low < (1ull << 32)) {
-      uint32_t divMod = static_cast<uint32_t>(r.low);
-      res.high = l.high / divMod;
-      unsigned long long temp = (static_cast<uint64_t>(l.high % divMod) << 32) + (l.low >> 32);
-      res.low = ((temp / divMod) << 32) + ((static_cast<uint64_t>(temp % divMod) << 32) + (l.low & uint128_t::k_MaskLow)) / divMod;
+    static constexpr FixedUInt fromNative(n_Int::native_uint128_t x)
+    {
+        return {static_cast<uint64_t>(x), static_cast<uint64_t>(x >> 64)};
     }
-    else {
-      unsigned shift = count_leading_zero(r);
-      r <<= shift;
-      if (shift >= 64) {
-        unsigned shift2 = shift - 64;
-        do{
-          if (l >= r) {
-            res.high |= (1ull << shift2);
-            l -= r;
-          }
-          r >>= 1;
-        }while(shift2--);
-        shift = 63;
-      }
-      do{
-        if (l >= r) {
-          res.high |= (1ull << shift);
-          l -= r;
-        }
-        r >>= 1;
-      }while(shift--);
+#endif
+
+    ///returns the low word of a * b + add + carry, the high word goes to carry
+    static constexpr uint64_t mulAddWord(uint64_t a, uint64_t b,
+                                         uint64_t add, uint64_t &carry)
+    {
+        uint64_t high = 0;
+        uint64_t low = n_Int::mulWide(a, b, high);
+        low += carry;
+        high += low < carry;
+        low += add;
+        high += low < add;
+        carry = high;
+        return low;
+    }
+
+    static constexpr FixedUInt doShl(const FixedUInt &x, uint64_t sh);
+    static constexpr FixedUInt doShr(const FixedUInt &x, uint64_t sh);
+    static constexpr FixedUInt doDivMod(const FixedUInt &l, const FixedUInt &r,
+                                        FixedUInt &rem);
+
+    std::istream& extractFrom(std::istream&);
+    std::ostream& insertTo(std::ostream&) const;
+};
+
+using uint128_t = FixedUInt<128>;
+using uint256_t = FixedUInt<256>;
+using uint512_t = FixedUInt<512>;
+
+
+template<std::size_t Bits>
+constexpr FixedUInt<Bits> FixedUInt<Bits>::doShl(const FixedUInt &x, uint64_t sh)
+{
+    const std::size_t limbShift = sh / 64;
+    const int bitShift = sh % 64;
+    FixedUInt res{};
+    for (std::size_t i = k_Limbs; i-- > limbShift; ) {
+      res.limbs[i] = x.limbs[i - limbShift] << bitShift;
+      if (bitShift && i > limbShift)
+        res.limbs[i] |= x.limbs[i - limbShift - 1] >> (64 - bitShift);
     }
     return res;
 }
-inline constexpr uint128_t operator % (uint128_t l, uint128_t r)
+template<std::size_t Bits>
+constexpr FixedUInt<Bits> FixedUInt<Bits>::doShr(const FixedUInt &x, uint64_t sh)
 {
-    uint128_t res{};
-    if (l < r) res = l;
-    else if (!l.high) res.low = l.low % r.low;
-    else if (r.low < (1ull << 32)) {
-      uint32_t div = static_cast<uint32_t>(r.low);
-      res.low = ((((((l.high % div) << 32) + (l.low >> 32)) % div) << 32) + (l.low & uint128_t::k_MaskLow)) % div;
-    }
-    else {
-      unsigned shift = count_leading_zero(r);
-      res = l;
-      r <<= shift;
-      do{
-        if (res >= r) res -= r;
-        r >>= 1;
-      }while(shift--);
+    const std::size_t limbShift = sh / 64;
+    const int bitShift = sh % 64;
+    FixedUInt res{};
+    for (std::size_t i = 0; i + limbShift < k_Limbs; ++i) {
+      res.limbs[i] = x.limbs[i + limbShift] >> bitShift;
+      if (bitShift && i + limbShift + 1 < k_Limbs)
+        res.limbs[i] |= x.limbs[i + limbShift + 1] << (64 - bitShift);
     }
     return res;
 }
 
-inline constexpr uint128_t& operator *= (uint128_t &x, const uint128_t &d)
-{   return x = x * d; }
-inline constexpr uint128_t& operator /= (uint128_t &x, const uint128_t &d)
-{   return x = x / d; }
-inline constexpr uint128_t& operator %= (uint128_t &x, const uint128_t &d)
-{   return x = x % d; }
+///the quotient of l / r, stores the remainder in rem; Knuth's algorithm D
+///on 64 bit limbs, each quotient limb is estimated by a 128 by 64 bit
+///division of the leading words
+template<std::size_t Bits>
+constexpr FixedUInt<Bits> FixedUInt<Bits>::doDivMod(const FixedUInt &l,
+                                                    const FixedUInt &r,
+                                                    FixedUInt &rem)
+{
+#if ACHIBULUP__UINT128_NATIVE
+    if (k_Limbs == 2) {
+      const n_Int::native_uint128_t nl = toNative(l), nr = toNative(r);
+      rem = fromNative(nl % nr);
+      return fromNative(nl / nr);
+    }
+#endif
+    FixedUInt quot{};
+    std::size_t n = k_Limbs;
+    while (n > 1 && !r.limbs[n - 1]) --n;
+    if (n == 1) {
+      uint64_t carry = 0;
+      for (std::size_t i = k_Limbs; i--; )
+        quot.limbs[i] = n_Int::divide128By64(carry, l.limbs[i], r.limbs[0], carry);
+      rem = FixedUInt(carry);
+      return quot;
+    }
+    if (l < r) {
+      rem = l;
+      return quot;
+    }
+
+    const int shift = count_leading_zero(r.limbs[n - 1]);
+    uint64_t v[k_Limbs] = {}, u[k_Limbs + 1] = {};
+    for (std::size_t i = 0; i < n; ++i)
+      v[i] = (r.limbs[i] << shift)
+           | (shift && i ? r.limbs[i - 1] >> (64 - shift) : 0);
+    for (std::size_t i = 0; i < k_Limbs; ++i)
+      u[i] = (l.limbs[i] << shift)
+           | (shift && i ? l.limbs[i - 1] >> (64 - shift) : 0);
+    u[k_Limbs] = shift ? l.limbs[k_Limbs - 1] >> (64 - shift) : 0;
+
+    for (std::size_t j = k_Limbs - n + 1; j--; ) {
+      ///u[j + n] never exceeds v[n - 1], when they are equal the estimate
+      ///is capped and rhat may overflow, so the refinement is skipped
+      uint64_t qhat = ~0ull, rhat = 0;
+      bool refine = u[j + n] < v[n - 1];
+      if (refine)
+        qhat = n_Int::divide128By64(u[j + n], u[j + n - 1], v[n - 1], rhat);
+      else {
+        rhat = u[j + n - 1] + v[n - 1];
+        refine = rhat >= v[n - 1];
+      }
+      while (refine) {
+        uint64_t high = 0;
+        const uint64_t low = n_Int::mulWide(qhat, v[n - 2], high);
+        if (high < rhat || (high == rhat && low <= u[j + n - 2])) break;
+        --qhat;
+        rhat += v[n - 1];
+        refine = rhat >= v[n - 1];
+      }
+
+      uint64_t carry = 0, borrow = 0;
+      for (std::size_t i = 0; i <= n; ++i) {
+        const uint64_t prod = i < n ? mulAddWord(qhat, v[i], 0, carry) : carry;
+        const uint64_t diff = u[i + j] - prod;
+        const uint64_t next = diff > u[i + j];
+        u[i + j] = diff - borrow;
+        borrow = next + (u[i + j] > diff);
+      }
+      if (borrow) {
+        --qhat;
+        carry = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+          const uint64_t sum = u[i + j] + carry;
+          carry = sum < carry;
+          u[i + j] = sum + v[i];
+          carry += u[i + j] < sum;
+        }
+        u[j + n] += carry;
+      }
+      quot.limbs[j] = qhat;
+    }
 
+    rem = FixedUInt{};
+    for (std::size_t i = 0; i < n; ++i)
+      rem.limbs[i] = (u[i] >> shift) | (shift ? u[i + 1] << (64 - shift) : 0);
+    return quot;
+}
 
 
-template<typename Tp, typename = EnableIf_t<std::is_integral<Tp>::value>>
-constexpr bool operator == (const uint128_t &l, Tp r)
+namespace n_Int
 {
-    return !l.high && l.low == r;
-}
-template<typename Tp, typename = EnableIf_t<std::is_integral<Tp>::value>>
-constexpr bool operator == (Tp l, const uint128_t &r)
-{   return r == l; }
-template<typename Tp, typename = EnableIf_t<std::is_integral<Tp>::value>>
-constexpr bool operator != (const uint128_t &l, Tp r)
-{   return !(l == r); }
-template<typename Tp, typename = EnableIf_t<std::is_integral<Tp>::value>>
-constexpr bool operator != (Tp l, const uint128_t &r)
-{   return !(r == l); }
-template<typename Tp, typename = EnableIf_t<std::is_integral<Tp>::value>>
-constexpr bool operator < (const uint128_t &l, Tp r)
+template<std::size_t Bits>
+constexpr bool fitsLowLimb(const FixedUInt<Bits> &x)
 {
-    return !l.high && l.low < r;
+    for (std::size_t i = 1; i < x.k_Limbs; ++i)
+      if (x.limbs[i]) return false;
+    return true;
 }
-template<typename Tp, typename = EnableIf_t<std::is_integral<Tp>::value>>
-constexpr bool operator < (Tp l, const uint128_t &r)
+} //namespace n_Int
+
+template<std::size_t Bits, typename Tp,
+         typename = EnableIf_t<std::is_integral<Tp>::value>>
+constexpr Tp operator << (Tp x, const FixedUInt<Bits> &sh)
 {
-    return r.high || l < r.low;
+    return x << sh.limbs[0];
 }
-template<typename Tp, typename = EnableIf_t<std::is_integral<Tp>::value>>
-constexpr bool operator > (const uint128_t &l, Tp r)
-{  return r < l; }
-template<typename Tp, typename = EnableIf_t<std::is_integral<Tp>::value>>
-constexpr bool operator > (Tp l, const uint128_t &r)
-{  return r < l; }
-template<typename Tp, typename = EnableIf_t<std::is_integral<Tp>::value>>
-constexpr bool operator <= (const uint128_t &l, Tp r)
-{  return !(r < l); }
-template<typename Tp, typename = EnableIf_t<std::is_integral<Tp>::value>>
-constexpr bool operator <= (Tp l, const uint128_t &r)
-{  return !(r < l); }
-template<typename Tp, typename = EnableIf_t<std::is_integral<Tp>::value>>
-constexpr bool operator >= (const uint128_t &l, Tp r)
-{  return !(l < r); }
-template<typename Tp, typename = EnableIf_t<std::is_integral<Tp>::value>>
-constexpr bool operator >= (Tp l, const uint128_t &r)
-{  return !(l < r); }
-
-
-
-template<typename Tp, typename = EnableIf_t<std::is_integral<Tp>::value>>
-constexpr Tp operator << (Tp x, const uint128_t &sh)
-{ 
-    return sh.high ? (x << (64 + !sh.high)) : (x << sh.low);
-}
-template<typename Tp, typename = EnableIf_t<std::is_integral<Tp>::value>>
-constexpr Tp operator >> (Tp x, const uint128_t &sh)
-{ 
-    return sh.high ? (x >> (64 + !sh.high)) : (x >> sh.low);
+template<std::size_t Bits, typename Tp,
+         typename = EnableIf_t<std::is_integral<Tp>::value>>
+constexpr Tp operator >> (Tp x, const FixedUInt<Bits> &sh)
+{
+    return x >> sh.limbs[0];
 }
-template<typename Tp, typename = EnableIf_t<std::is_integral<Tp>::value>>
-constexpr Tp& operator &= (Tp &x, const uint128_t &v)
-{ 
-    return x = x & v.low;
+template<std::size_t Bits, typename Tp,
+         typename = EnableIf_t<std::is_integral<Tp>::value>>
+constexpr Tp& operator &= (Tp &x, const FixedUInt<Bits> &v)
+{
+    return x = x & v.limbs[0];
 }
-template<typename Tp, typename = EnableIf_t<std::is_integral<Tp>::value>>
-constexpr Tp& operator <<= (Tp &x, const uint128_t &sh)
-{ 
+template<std::size_t Bits, typename Tp,
+         typename = EnableIf_t<std::is_integral<Tp>::value>>
+constexpr Tp& operator <<= (Tp &x, const FixedUInt<Bits> &sh)
+{
     return x = x << sh;
 }
-template<typename Tp, typename = EnableIf_t<std::is_integral<Tp>::value>>
-constexpr Tp& operator >>= (Tp &x, const uint128_t &sh)
-{ 
+template<std::size_t Bits, typename Tp,
+         typename = EnableIf_t<std::is_integral<Tp>::value>>
+constexpr Tp& operator >>= (Tp &x, const FixedUInt<Bits> &sh)
+{
     return x = x >> sh;
 }
-template<typename Tp, typename = EnableIf_t<std::is_integral<Tp>::value>>
-constexpr Tp& operator /= (Tp &x, const uint128_t &v)
-{ 
-    return (v.high) ? (x = 0) : (x /= v.low);
+template<std::size_t Bits, typename Tp,
+         typename = EnableIf_t<std::is_integral<Tp>::value>>
+constexpr Tp& operator /= (Tp &x, const FixedUInt<Bits> &v)
+{
+    return n_Int::fitsLowLimb(v) ? (x /= v.limbs[0]) : (x = 0);
 }
-template<typename Tp, typename = EnableIf_t<std::is_integral<Tp>::value>>
-constexpr Tp& operator %= (Tp &x, const uint128_t &v)
-{ 
-    return (v.high) ? x : (x %= v.low);
+template<std::size_t Bits, typename Tp,
+         typename = EnableIf_t<std::is_integral<Tp>::value>>
+constexpr Tp& operator %= (Tp &x, const FixedUInt<Bits> &v)
+{
+    return n_Int::fitsLowLimb(v) ? (x %= v.limbs[0]) : x;
 }
 
 
-inline std::istream& uint128_t::extractFrom(std::istream &is)
+template<std::size_t Bits>
+std::istream& FixedUInt<Bits>::extractFrom(std::istream &is)
 {
     std::string istr;
     is >> istr;
-    uint128_t &x = *this;
+    FixedUInt &x = *this;
     x = {};
-    uint64_t temp1, temp2;
-    for(std::string::size_type i = 0, len = istr.size(); i < len; ++i) {
-      temp1 = (x.low & uint128_t::k_MaskLow) * n_Int::ten;
-      temp2 = (temp1 >> 32) + ((x.low >> 32) * n_Int::ten);
-      x.low = (temp1 & uint128_t::k_MaskLow) + (temp2 << 32);
-      x.high = x.high * n_Int::ten + (temp2 >> 32);
-      x.low += istr[i] - '0';
-    }
+    for(std::string::size_type i = 0, len = istr.size(); i < len; ++i)
+      x = x * FixedUInt(n_Int::ten) + FixedUInt(istr[i] - '0');
     return is;
 }
 
-inline std::ostream& uint128_t::insertTo(std::ostream &os) const
+template<std::size_t Bits>
+std::ostream& FixedUInt<Bits>::insertTo(std::ostream &os) const
 {
-    uint128_t x = *this;
-    char ostr[40];
+    ///log10(2) < 1/3
+    constexpr int size = Bits / 3 + 2;
+    FixedUInt x = *this;
+    char ostr[size];
     if (!x) return os << '0';
-    int first = 40;
+    int first = size - 1;
+    ostr[first] = '\0';
     while(x) {
-      ostr[--first] = int(x % n_Int::ten) + '0';
-      x /= n_Int::ten;
+      FixedUInt digit{};
+      x = doDivMod(x, FixedUInt(n_Int::ten), digit);
+      ostr[--first] = int(digit.limbs[0]) + '0';
     }
     os << (ostr + first);
     return os;
@@ -0,0 +1,265 @@
+#ifndef BIGNUM_EXPR_HPP_INCLUDED
+#define BIGNUM_EXPR_HPP_INCLUDED
+
+//Opt-in expression templates for uInt and Int
+//an expression starting with lazy() is not computed operator by operator,
+//it's accumulated term by term into one destination reserved up front,
+//and the products of two leaves go through addmul/submul:
+//    Int r = lazy(a) * b + lazy(c) * d - e;
+//    acc += lazy(x) * y;
+//the nodes hold references to their operands, so an expression must be 
+//used in the full-expression that builds it, never stored with auto
+//a uInt expression is added and subtracted from left to right, 
+//so it underflows where the same expression computed eagerly would
+
+
+#include "Bignum.hpp"
+
+namespace Achibulup{
+
+namespace n_Int{
+
+struct ExprAccess
+{
+    static size_type size(const uInt &x)
+    {
+        return x.size();
+    }
+    static size_type size(const Int &x)
+    {
+        return x.m_abs.size();
+    }
+    static void reserve(uInt &x, size_type cap)
+    {
+        x.reserve(cap);
+    }
+    static void reserve(Int &x, size_type cap)
+    {
+        x.m_abs.reserve(cap);
+    }
+};
+
+
+template<typename Num, typename Derived>
+class Expr
+{
+  public:
+    const Derived& self() const
+    {
+        return static_cast<const Derived&>(*this);
+    }
+
+    operator Num () const
+    {
+        Num res;
+        ///addmul wants a limb of headroom on top of the result
+        ExprAccess::reserve(res, this->self().maxSize() + 1);
+        this->self().accumulate(res, false);
+        return res;
+    }
+};
+
+///refers to a variable, or holds a constant when Ref is Num
+template<typename Num, typename Ref = const Num&>
+class Leaf : public Expr<Num, Leaf<Num, Ref>>
+{
+  public:
+    explicit Leaf(Ref val) : m_val(val) {}
+
+    const Num& value() const noexcept
+    {
+        return this->m_val;
+    }
+    size_type maxSize() const
+    {
+        return ExprAccess::size(this->m_val);
+    }
+    bool refersTo(const Num &x) const noexcept
+    {
+        return &this->m_val == &x;
+    }
+    void accumulate(Num &dest, bool negate) const
+    {
+        if (negate) dest -= this->m_val;
+        else dest += this->m_val;
+    }
+
+  private:
+    Ref m_val;
+};
+
+///the leaf an operand of type Tp is stored in, 
+///variables are referred to and integer constants are converted
+template<typename Num, typename Tp, typename = void>
+struct LeafOf {};
+template<typename Num>
+struct LeafOf<Num, Num>
+{
+    using type = Leaf<Num>;
+};
+template<typename Num, typename Tp>
+struct LeafOf<Num, Tp, EnableIf_t<std::is_integral<Tp>::value, void>>
+{
+    using type = Leaf<Num, Num>;
+};
+template<typename Num, typename Tp>
+using LeafOf_t = typename LeafOf<Num, typename std::decay<Tp>::type>::type;
+
+template<typename Num, typename L, typename R, bool k_Subtract>
+class Sum : public Expr<Num, Sum<Num, L, R, k_Subtract>>
+{
+  public:
+    Sum(const L &lhs, const R &rhs) : m_lhs(lhs), m_rhs(rhs) {}
+
+    size_type maxSize() const
+    {
+        return std::max(this->m_lhs.maxSize(), this->m_rhs.maxSize()) + 1;
+    }
+    bool refersTo(const Num &x) const noexcept
+    {
+        return this->m_lhs.refersTo(x) || this->m_rhs.refersTo(x);
+    }
+    void accumulate(Num &dest, bool negate) const
+    {
+        this->m_lhs.accumulate(dest, negate);
+        this->m_rhs.accumulate(dest, negate != k_Subtract);
+    }
+
+  private:
+    L m_lhs;
+    R m_rhs;
+};
+
+template<typename Num, typename L, typename R>
+class Product : public Expr<Num, Product<Num, L, R>>
+{
+  public:
+    Product(const L &lhs, const R &rhs) : m_lhs(lhs), m_rhs(rhs) {}
+
+    size_type maxSize() const
+    {
+        return this->m_lhs.maxSize() + this->m_rhs.maxSize();
+    }
+    bool refersTo(const Num &x) const noexcept
+    {
+        return this->m_lhs.refersTo(x) || this->m_rhs.refersTo(x);
+    }
+    ///only the operands that are not leaves are computed into temporaries
+    void accumulate(Num &dest, bool negate) const
+    {
+        Num lhs_tmp, rhs_tmp;
+        const Num &lhs = operand(this->m_lhs, lhs_tmp);
+        const Num &rhs = operand(this->m_rhs, rhs_tmp);
+        if (negate) submul(dest, lhs, rhs);
+        else addmul(dest, lhs, rhs);
+    }
+
+  private:
+    template<typename Ref>
+    static const Num& operand(const Leaf<Num, Ref> &x, Num&)
+    {
+        return x.value();
+    }
+    template<typename Node>
+    static const Num& operand(const Node &x, Num &tmp)
+    {
+        tmp = x;
+        return tmp;
+    }
+
+    L m_lhs;
+    R m_rhs;
+};
+
+
+template<typename Num, typename L, typename R>
+Sum<Num, L, R, false> 
+operator + (const Expr<Num, L> &lhs, const Expr<Num, R> &rhs)
+{
+    return {lhs.self(), rhs.self()};
+}
+template<typename Num, typename L, typename Tp>
+Sum<Num, L, LeafOf_t<Num, Tp>, false> 
+operator + (const Expr<Num, L> &lhs, Tp &&rhs)
+{
+    return {lhs.self(), LeafOf_t<Num, Tp>(rhs)};
+}
+template<typename Num, typename R, typename Tp>
+Sum<Num, LeafOf_t<Num, Tp>, R, false> 
+operator + (Tp &&lhs, const Expr<Num, R> &rhs)
+{
+    return {LeafOf_t<Num, Tp>(lhs), rhs.self()};
+}
+
+template<typename Num, typename L, typename R>
+Sum<Num, L, R, true> 
+operator - (const Expr<Num, L> &lhs, const Expr<Num, R> &rhs)
+{
+    return {lhs.self(), rhs.self()};
+}
+template<typename Num, typename L, typename Tp>
+Sum<Num, L, LeafOf_t<Num, Tp>, true> 
+operator - (const Expr<Num, L> &lhs, Tp &&rhs)
+{
+    return {lhs.self(), LeafOf_t<Num, Tp>(rhs)};
+}
+template<typename Num, typename R, typename Tp>
+Sum<Num, LeafOf_t<Num, Tp>, R, true> 
+operator - (Tp &&lhs, const Expr<Num, R> &rhs)
+{
+    return {LeafOf_t<Num, Tp>(lhs), rhs.self()};
+}
+
+template<typename Num, typename L, typename R>
+Product<Num, L, R> 
+operator * (const Expr<Num, L> &lhs, const Expr<Num, R> &rhs)
+{
+    return {lhs.self(), rhs.self()};
+}
+template<typename Num, typename L, typename Tp>
+Product<Num, L, LeafOf_t<Num, Tp>> 
+operator * (const Expr<Num, L> &lhs, Tp &&rhs)
+{
+    return {lhs.self(), LeafOf_t<Num, Tp>(rhs)};
+}
+template<typename Num, typename R, typename Tp>
+Product<Num, LeafOf_t<Num, Tp>, R> 
+operator * (Tp &&lhs, const Expr<Num, R> &rhs)
+{
+    return {LeafOf_t<Num, Tp>(lhs), rhs.self()};
+}
+
+///accumulates straight into dest unless the expression reads dest
+template<typename Num, typename Derived>
+Num& operator += (Num &dest, const Expr<Num, Derived> &expr)
+{
+    if (expr.self().refersTo(dest)) return dest += Num(expr);
+    ExprAccess::reserve(dest, std::max(ExprAccess::size(dest), 
+                                       expr.self().maxSize()) + 1);
+    expr.self().accumulate(dest, false);
+    return dest;
+}
+template<typename Num, typename Derived>
+Num& operator -= (Num &dest, const Expr<Num, Derived> &expr)
+{
+    if (expr.self().refersTo(dest)) return dest -= Num(expr);
+    ExprAccess::reserve(dest, std::max(ExprAccess::size(dest), 
+                                       expr.self().maxSize()) + 1);
+    expr.self().accumulate(dest, true);
+    return dest;
+}
+
+} //namespace n_Int
+
+
+inline n_Int::Leaf<uInt> lazy(const uInt &x) noexcept
+{
+    return n_Int::Leaf<uInt>(x);
+}
+inline n_Int::Leaf<Int> lazy(const Int &x) noexcept
+{
+    return n_Int::Leaf<Int>(x);
+}
+
+} //namespace Achibulup
+#endif //BIGNUM_EXPR_HPP_INCLUDED
@@ -2,22 +2,41 @@
 #define SOLVE_POLYNOMIAL_RATIONAL_H_INCLUDED
 
 #include <cmath>
+#include <stdexcept>
 #include "polynomial.h"
 #include "rational.h"
 
+///big integer types provide their own isqrt and isPerfectSquare
 template<typename Tp, 
          typename = typename std::enable_if<
            std::is_integral<Tp>::value>::type>
-bool isSquare(Tp x)
+Tp isqrt(Tp x)
 {
-    if (x < 0) return false;
+    if (x < 0) throw std::domain_error("square root of a negative number");
     Tp sqrt = llroundl(sqrtl(x));
+    ///compared by division, the squares can overflow near the maximum
+    while (sqrt != 0 && sqrt > x / sqrt) --sqrt;
+    while (sqrt + 1 <= x / (sqrt + 1)) ++sqrt;
+    return sqrt;
+}
+template<typename Tp, 
+         typename = typename std::enable_if<
+           std::is_integral<Tp>::value>::type>
+bool isPerfectSquare(Tp x)
+{
+    if (x < 0) return false;
+    Tp sqrt = isqrt(x);
     return (sqrt * sqrt == x);
 }
 template<typename Tp>
+bool isSquare(Tp x)
+{
+    return isPerfectSquare(x);
+}
+template<typename Tp>
 bool isSquare(Rational<Tp> x)
 {
-    return isSquare(x.getNum()) && isSquare(x.getDenom());
+    return isPerfectSquare(x.getNum()) && isPerfectSquare(x.getDenom());
 }
 
 template<typename Tp>
@@ -33,8 +52,8 @@ std::vector<Rational<Tp>> solve(Polynomial<Rational<Tp>> equation)
       Rational<Tp> delta = b * b - 4 * a * c;
       if (isSquare(delta)) {
         if (!delta) return {-b / (2 * a)};
-        Rational<Tp> sdelta = frac(Tp(llroundl(sqrtl(delta.getNum()))),
-                                   Tp(llroundl(sqrtl(delta.getDenom()))));
+        Rational<Tp> sdelta = frac(isqrt(delta.getNum()),
+                                   isqrt(delta.getDenom()));
         std::vector<Rational<Tp>> res{(-b + sdelta) / (2 * a),
                                       (-b - sdelta) / (2 * a)};
         using std::swap;